@@ -0,0 +1,227 @@
+//-----------------------------------------------------------------------------
+//   accel.c
+//
+//   Anderson acceleration of a fixed-point iteration x = G(x).
+//
+//   Each call supplies the current iterate x and the result g = G(x) of
+//   one more pass of the iteration. The differences between the residuals
+//   f = g - x (and between the g's) of the last m passes are kept, and the
+//   combination of them that best cancels the current residual in a least
+//   squares sense is used to extrapolate a better next iterate than g.
+//
+//   Only the entries listed on a call take part in it, so the iteration
+//   can work on a changing subset of a larger vector. An entry that was not
+//   listed on the previous call has no usable history and is left for the
+//   other entries to carry until it has been listed on consecutive calls.
+//
+//   Date:     10/16/26
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <math.h>
+#include "accel.h"
+
+//-----------------------------------------------------------------------------
+//    Local declarations
+//-----------------------------------------------------------------------------
+static int     Nsize;     // length of the vectors being iterated
+static int     Mmax;      // max. number of past differences kept
+static int     Mused;     // number of past differences now kept
+static int     Next;      // column where next differences are stored
+static long    Calls;     // number of calls made to accel_mix
+static long*   ColCall;   // call on which each column was stored
+static long*   LastCall;  // last call on which each entry was listed
+static long*   Since;     // first call of each entry's current listing
+static double* Fprev;     // residual of each entry on its last call
+static double* Gprev;     // value of G for each entry on its last call
+static double* DF;        // past differences in residuals (by column)
+static double* DG;        // past differences in G (by column)
+static double* A;         // normal equations matrix
+static double* B;         // normal equations right hand side
+
+static int  solveNormalEqns(int n);
+
+
+//-----------------------------------------------------------------------------
+//    open the accelerator for vectors of length n keeping up to m past
+//    differences (returns 1 if successful, 0 if not)
+//-----------------------------------------------------------------------------
+int accel_open(int n, int m)
+{
+    accel_close();
+    Nsize = n;
+    Mmax = m;
+    if ( n <= 0 || m <= 0 ) return 1;
+    ColCall  = (long *) calloc(m, sizeof(long));
+    LastCall = (long *) calloc(n, sizeof(long));
+    Since    = (long *) calloc(n, sizeof(long));
+    Fprev    = (double *) calloc(n, sizeof(double));
+    Gprev    = (double *) calloc(n, sizeof(double));
+    DF       = (double *) calloc((size_t)m * n, sizeof(double));
+    DG       = (double *) calloc((size_t)m * n, sizeof(double));
+    A        = (double *) calloc(m * m, sizeof(double));
+    B        = (double *) calloc(m, sizeof(double));
+    if ( !ColCall || !LastCall || !Since || !Fprev || !Gprev || !DF ||
+         !DG || !A || !B ) return 0;
+    accel_reset();
+    return 1;
+}
+
+//-----------------------------------------------------------------------------
+//    close the accelerator
+//-----------------------------------------------------------------------------
+void accel_close()
+{
+    free(ColCall);  ColCall = NULL;
+    free(LastCall); LastCall = NULL;
+    free(Since);    Since = NULL;
+    free(Fprev);    Fprev = NULL;
+    free(Gprev);    Gprev = NULL;
+    free(DF);       DF = NULL;
+    free(DG);       DG = NULL;
+    free(A);        A = NULL;
+    free(B);        B = NULL;
+    Nsize = 0;
+    Mmax = 0;
+}
+
+//-----------------------------------------------------------------------------
+//    discard all history (call when a new iteration is started)
+//-----------------------------------------------------------------------------
+void accel_reset()
+{
+    // --- skipping a call number leaves every entry without a previous call
+    Calls += 2;
+    Mused = 0;
+    Next = 0;
+}
+
+//-----------------------------------------------------------------------------
+//    replace g[index[k]], k = 0..count-1, with the accelerated next iterate
+//    given the current iterate x and the result g = G(x)
+//-----------------------------------------------------------------------------
+void accel_mix(int count, int index[], double x[], double g[])
+{
+    int    i, k, p, q;
+    double f, s;
+    double* df;
+    double* dg;
+
+    if ( Mmax <= 0 ) return;
+    Calls++;
+
+    // --- store the change in residual & in G since the last call
+    df = DF + (size_t)Next * Nsize;
+    dg = DG + (size_t)Next * Nsize;
+    for (k = 0; k < count; k++)
+    {
+        i = index[k];
+        f = g[i] - x[i];
+        if ( LastCall[i] == Calls - 1 )
+        {
+            df[i] = f - Fprev[i];
+            dg[i] = g[i] - Gprev[i];
+        }
+        else
+        {
+            Since[i] = Calls;
+            df[i] = 0.0;
+            dg[i] = 0.0;
+        }
+        LastCall[i] = Calls;
+        Fprev[i] = f;
+        Gprev[i] = g[i];
+    }
+    ColCall[Next] = Calls;
+    Next = (Next + 1) % Mmax;
+    if ( Mused < Mmax ) Mused++;
+
+    // --- form the normal equations of the least squares problem
+    //     (a column is only valid for entries listed when it was stored
+    //     and on the call before)
+    for (p = 0; p < Mused; p++)
+    {
+        B[p] = 0.0;
+        for (q = 0; q <= p; q++) A[p*Mmax+q] = 0.0;
+    }
+    for (k = 0; k < count; k++)
+    {
+        i = index[k];
+        f = Fprev[i];
+        for (p = 0; p < Mused; p++)
+        {
+            if ( ColCall[p] <= Since[i] ) continue;
+            s = DF[(size_t)p*Nsize + i];
+            B[p] += s * f;
+            for (q = 0; q <= p; q++)
+            {
+                if ( ColCall[q] <= Since[i] ) continue;
+                A[p*Mmax+q] += s * DF[(size_t)q*Nsize + i];
+            }
+        }
+    }
+    if ( !solveNormalEqns(Mused) ) return;
+
+    // --- extrapolate each entry from the combination of past differences
+    for (k = 0; k < count; k++)
+    {
+        i = index[k];
+        s = 0.0;
+        for (p = 0; p < Mused; p++)
+        {
+            if ( ColCall[p] <= Since[i] ) continue;
+            s += B[p] * DG[(size_t)p*Nsize + i];
+        }
+        g[i] -= s;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//    solve the n x n normal equations held in the lower triangle of A,
+//    leaving the solution in B (returns 1 if successful, 0 if not)
+//-----------------------------------------------------------------------------
+int solveNormalEqns(int n)
+{
+    int    p, q, r;
+    double s, scale = 0.0;
+
+    // --- add a small amount to the diagonal to guard against columns
+    //     that are nearly linearly dependent
+    for (p = 0; p < n; p++)
+    {
+        if ( A[p*Mmax+p] > scale ) scale = A[p*Mmax+p];
+    }
+    if ( scale <= 0.0 ) return 0;
+    for (p = 0; p < n; p++) A[p*Mmax+p] += 1.0e-10 * scale;
+
+    // --- Cholesky factorization in place
+    for (p = 0; p < n; p++)
+    {
+        for (q = 0; q <= p; q++)
+        {
+            s = A[p*Mmax+q];
+            for (r = 0; r < q; r++) s -= A[p*Mmax+r] * A[q*Mmax+r];
+            if ( q < p ) A[p*Mmax+q] = s / A[q*Mmax+q];
+            else
+            {
+                if ( s <= 0.0 ) return 0;
+                A[p*Mmax+p] = sqrt(s);
+            }
+        }
+    }
+
+    // --- forward & back substitution
+    for (p = 0; p < n; p++)
+    {
+        s = B[p];
+        for (r = 0; r < p; r++) s -= A[p*Mmax+r] * B[r];
+        B[p] = s / A[p*Mmax+p];
+    }
+    for (p = n - 1; p >= 0; p--)
+    {
+        s = B[p];
+        for (r = p + 1; r < n; r++) s -= A[r*Mmax+p] * B[r];
+        B[p] = s / A[p*Mmax+p];
+    }
+    return 1;
+}
@@ -0,0 +1,13 @@
+//-----------------------------------------------------------------------------
+//  accel.h
+//
+//  Header file for the Anderson acceleration of fixed-point iterations
+//  contained in accel.c
+//
+//-----------------------------------------------------------------------------
+
+// functions that open, close, and use the accelerator
+int  accel_open(int n, int m);
+void accel_close(void);
+void accel_reset(void);
+void accel_mix(int count, int index[], double x[], double g[]);
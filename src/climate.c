@@ -808,7 +808,8 @@ void setTemp(DateTime theDate)
         k = Temp.tSeries;
         if ( k >= 0)
         {
-            Temp.ta = table_tseriesLookup(&Tseries[k], theDate, TRUE);
+            Temp.ta = table_tseriesLookupAt(&Tseries[k], &Temp.tsCursor,       //(OPENSWMM 5.1.913)
+                                            theDate, TRUE);
 
             // --- convert from deg. C to deg. F if need be
             if ( UnitSystem == SI )
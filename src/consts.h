@@ -24,6 +24,9 @@
 #define   MAXTOKS            40             // Max. items per line of input
 #define   MAXSTATES          10             // Max. # computed hyd. variables
 #define   MAXODES            4              // Max. # ODE's to be solved
+#define   MAXCLASSES         6              // Max. # multirate DW step classes  //(OPENSWMM 5.1.913)
+#define   MAXACCEL           10             // Max. # Anderson acceleration terms //(OPENSWMM 5.1.913)
+#define   MAXTRIALBINS       8              // Max. # DW trial count bins reported //(OPENSWMM 5.1.913)
 #define   NA                 -1             // NOT APPLICABLE code
 #define   TRUE               1              // Value for TRUE state
 #define   FALSE              0              // Value for FALSE state
@@ -113,6 +113,7 @@ struct  TAction
    int     attribute;        // attribute of link being controlled
    int     curve;            // index of curve for modulated control
    int     tseries;          // index of time series for modulated control
+   int     tsCursor;         // position in time series
    double  value;            // control setting for link attribute
    double  kp, ki, kd;       // coeffs. for PID modulated control
    double  e1, e2;           // PID set point error from previous time steps
@@ -716,6 +717,7 @@ int  addAction(int r, char* tok[], int nToks)
     a->attribute = attrib;
     a->curve     = curve;
     a->tseries   = tseries;
+    a->tsCursor  = 0;
     a->value     = values[0];
     if ( attrib == r_PID )
     {
@@ -813,7 +815,8 @@ void  updateActionValue(struct TAction* a, DateTime currentTime, double dt)
     }
     else if ( a->tseries >= 0 )
     {
-        a->value = table_tseriesLookup(&Tseries[a->tseries], currentTime, TRUE);
+        a->value = table_tseriesLookupAt(&Tseries[a->tseries], &a->tsCursor,   //(OPENSWMM 5.1.913)
+                                         currentTime, TRUE);
     }
     else if ( a->attribute == r_PID )
     {
@@ -18,28 +18,48 @@
 //
 //   Build 5.1.012:
 //   - Modified uniform loss rate term of conduit momentum equation.
+//
+//   OpenSWMM 5.1.913:
+//   - Node heads are read from, and new link states also saved to, the
+//     packed routing state arrays declared in dynwave.h.
+//   - Conduits are updated in blocks grouped by shape, with the geometry of
+//     all conduits in a block found by the batch geometry functions of
+//     xsect.c.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
 #include "headers.h"
+#include "dynwave.h"                                                           //(OPENSWMM 5.1.913)
 #include <math.h>
 
 static const  double MAXVELOCITY =  50.;     // max. allowable velocity (ft/sec)
 
+// Flow conditions at the ends of a conduit passed between the stages of
+// a batch of conduit flow updates                                             //(OPENSWMM 5.1.913)
+typedef struct
+{
+    double h1, h2;             // upstream/downstream flow heads (ft)
+    double y1, y2;             // upstream/downstream flow depths (ft)
+    double fasnh;              // fraction between norm. & crit. depth
+} TConduitEnds;
+
+static void   sortByShape(int links[], int n, int sorted[]);                   //(OPENSWMM 5.1.913)
+static void   findConduitEnds(int j, TConduitEnds* ends);
+static void   solveMomentum(int j, TConduitEnds* ends, double a[], double r[],
+              int steps, double omega, double dt);
 static int    getFlowClass(int link, double q, double h1, double h2,
               double y1, double y2, double* criticalDepth, double* normalDepth,
               double* fasnh);
-static void   findSurfArea(int link, double q, double length, double* h1,
-              double* h2, double* y1, double* y2);
+static void   findSurfDepths(int j, TConduitEnds* ends, double yWidth[]);      //(OPENSWMM 5.1.913)
+static void   setSurfArea(int j, double fasnh, double width[]);
 static double findLocalLosses(int link, double a1, double a2, double aMid,
               double q);
 
-static double getWidth(TXsect* xsect, double y);
-static double getArea(TXsect* xsect, double y);
-static double getHydRad(TXsect* xsect, double y);
+static double getWidthDepth(TXsect* xsect, double y);                          //(OPENSWMM 5.1.913)
 
 static double checkNormalFlow(int j, double q, double y1, double y2,
               double a1, double r1);
+static void   saveLinkState(int j);                                            //(OPENSWMM 5.1.913)
 
 //=============================================================================
 
@@ -49,16 +69,180 @@ void  dwflow_findConduitFlow(int j, int steps, double omega, double dt)
 //           steps    = number of iteration steps taken
 //           omega    = under-relaxation parameter
 //           dt       = time step (sec)
-//  Output:  returns new flow value (cfs)
+//  Output:  none
 //  Purpose: updates flow in conduit link by solving finite difference
 //           form of continuity and momentum equations.
 //
 {
-    int    k;                          // index of conduit
+    dwflow_findConduitFlows(&j, 1, steps, omega, dt);                          //(OPENSWMM 5.1.913)
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+void  dwflow_findConduitFlows(int links[], int n, int steps, double omega,
+                              double dt)
+//
+//  Input:   links    = array of conduit link indexes
+//           n        = number of conduits in the array
+//           steps    = number of iteration steps taken
+//           omega    = under-relaxation parameter
+//           dt       = time step (sec)
+//  Output:  none
+//  Purpose: updates flow in a set of conduit links.
+//
+//  NOTE: conduits are processed in blocks of DW_BATCH sorted by shape,
+//        with the cross section geometry of all conduits in a block found
+//        by a single call to each of the batch geometry functions in
+//        xsect.c. The flow update of a conduit does not depend on that of
+//        any other conduit so the order in which they are processed does
+//        not change the results.
+//
+{
+    int     i, k, m;
+    int     block[DW_BATCH];           // indexes of conduits in a block
+    double  yFull;
+    TConduitEnds ends[DW_BATCH];       // flow conditions at conduit ends
+    TXsect* xsect[3*DW_BATCH];         // cross section of each depth
+    double  y[3*DW_BATCH];             // depths where geometry is found (ft)
+    double  w[3*DW_BATCH];             // top widths (ft)
+    double  a[3*DW_BATCH];             // flow areas (ft2)
+    double  r[3*DW_BATCH];             // hyd. radii (ft)
+
+    for (i = 0; i < n; i += DW_BATCH)
+    {
+        m = MIN(DW_BATCH, n - i);
+        sortByShape(&links[i], m, block);
+
+        // --- find flow depths at the ends of each conduit and the depths
+        //     at which top widths are needed to find its surface area
+        for (k = 0; k < m; k++)
+        {
+            findConduitEnds(block[k], &ends[k]);
+            findSurfDepths(block[k], &ends[k], &y[3*k]);
+            xsect[3*k] = &Link[block[k]].xsect;
+            xsect[3*k+1] = xsect[3*k];
+            xsect[3*k+2] = xsect[3*k];
+        }
+
+        // --- assign each conduit's surface area to its end nodes
+        xsect_getWofYs(xsect, y, w, 3*m);
+        for (k = 0; k < m; k++) setSurfArea(block[k], ends[k].fasnh, &w[3*k]);
+
+        // --- find areas & hyd. radii at each end & midpoint of each
+        //     conduit (flow depths can't exceed full depth of conduit)
+        for (k = 0; k < m; k++)
+        {
+            yFull = xsect[3*k]->yFull;
+            y[3*k]   = MIN(ends[k].y1, yFull);
+            y[3*k+1] = MIN(ends[k].y2, yFull);
+            y[3*k+2] = MIN(0.5 * (ends[k].y1 + ends[k].y2), yFull);
+        }
+        xsect_getAofYs(xsect, y, a, 3*m);
+        xsect_getRofYs(xsect, y, r, 3*m);
+
+        // --- update the flow in each conduit
+        for (k = 0; k < m; k++)
+        {
+            solveMomentum(block[k], &ends[k], &a[3*k], &r[3*k], steps,
+                          omega, dt);
+        }
+    }
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+void  sortByShape(int links[], int n, int sorted[])
+//
+//  Input:   links    = array of conduit link indexes
+//           n        = number of conduits in the array
+//  Output:  sorted   = the same conduits ordered by cross section shape
+//  Purpose: groups a block of conduits by shape so that the batch geometry
+//           functions see long runs of the same shape.
+//
+{
+    int i, type;
+    int start[FORCE_MAIN+2];           // start of each shape in sorted list
+
+    for (type = 0; type <= FORCE_MAIN+1; type++) start[type] = 0;
+    for (i = 0; i < n; i++) start[Link[links[i]].xsect.type + 1]++;
+    for (type = 1; type <= FORCE_MAIN+1; type++) start[type] += start[type-1];
+    for (i = 0; i < n; i++)
+    {
+        type = Link[links[i]].xsect.type;
+        sorted[start[type]++] = links[i];
+    }
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+void  findConduitEnds(int j, TConduitEnds* ends)
+//
+//  Input:   j        = link index
+//  Output:  ends     = heads & flow depths at each end of conduit
+//  Purpose: finds the current heads & flow depths at the ends of a conduit.
+//
+{
     int    n1, n2;                     // indexes of end nodes
     double z1, z2;                     // upstream/downstream invert elev. (ft)
     double h1, h2;                     // upstream/dounstream flow heads (ft)
     double y1, y2;                     // upstream/downstream flow depths (ft)
+    TXsect* xsect = &Link[j].xsect;    // ptr. to conduit's cross section data
+
+    // --- get most current heads at upstream and downstream ends of conduit
+    n1 = Link[j].node1;
+    n2 = Link[j].node2;
+    z1 = DwNode.invertElev[n1] + Link[j].offset1;
+    z2 = DwNode.invertElev[n2] + Link[j].offset2;
+    h1 = DwNode.newDepth[n1] + DwNode.invertElev[n1];
+    h2 = DwNode.newDepth[n2] + DwNode.invertElev[n2];
+    h1 = MAX(h1, z1);
+    h2 = MAX(h2, z2);
+
+    // --- get unadjusted upstream and downstream flow depths in conduit
+    //    (flow depth = head in conduit - elev. of conduit invert)
+    y1 = h1 - z1;
+    y2 = h2 - z2;
+    y1 = MAX(y1, FUDGE);
+    y2 = MAX(y2, FUDGE);
+
+    // --- flow depths can't exceed full depth of conduit
+    ends->y1 = MIN(y1, xsect->yFull);
+    ends->y2 = MIN(y2, xsect->yFull);
+    ends->h1 = h1;
+    ends->h2 = h2;
+}
+
+//=============================================================================
+
+void  solveMomentum(int j, TConduitEnds* ends, double a[], double r[],
+                    int steps, double omega, double dt)
+//
+//  Input:   j        = link index
+//           ends     = heads & flow depths at each end of conduit
+//           a        = flow areas at upstream end, downstream end and
+//                      midpoint of conduit (ft2)
+//           r        = hyd. radii at the same locations (ft)
+//           steps    = number of iteration steps taken
+//           omega    = under-relaxation parameter
+//           dt       = time step (sec)
+//  Output:  none
+//  Purpose: updates flow in conduit link by solving finite difference
+//           form of continuity and momentum equations.
+//
+//  NOTE: this is the remainder of the original dwflow_findConduitFlow()
+//        once conduit geometry has been found.
+//
+{
+    int    k;                          // index of conduit
+    int    n1, n2;                     // indexes of end nodes
+    double h1, h2;                     // upstream/dounstream flow heads (ft)
+    double y1, y2;                     // upstream/downstream flow depths (ft)
     double a1, a2;                     // upstream/downstream flow areas (ft2)
     double r1;                         // upstream hyd. radius (ft)
     double yMid, rMid, aMid;           // mid-stream or avg. values of y, r, & a
@@ -79,8 +263,6 @@ void  dwflow_findConduitFlow(int j, int steps, double omega, double dt)
     char   isFull = FALSE;             // TRUE if conduit flowing full
     char   isClosed = FALSE;           // TRUE if conduit closed
 
-
-
     // --- adjust isClosed status by any control action
     if ( Link[j].setting == 0 ) isClosed = TRUE;
 
@@ -89,27 +271,8 @@ void  dwflow_findConduitFlow(int j, int steps, double omega, double dt)
     barrels = Conduit[k].barrels;
     qOld = Link[j].oldFlow / barrels;
     qLast = Conduit[k].q1;
-
-    // --- get most current heads at upstream and downstream ends of conduit
     n1 = Link[j].node1;
     n2 = Link[j].node2;
-    z1 = Node[n1].invertElev + Link[j].offset1;
-    z2 = Node[n2].invertElev + Link[j].offset2;
-    h1 = Node[n1].newDepth + Node[n1].invertElev;
-    h2 = Node[n2].newDepth + Node[n2].invertElev;
-    h1 = MAX(h1, z1);
-    h2 = MAX(h2, z2);
-
-    // --- get unadjusted upstream and downstream flow depths in conduit
-    //    (flow depth = head in conduit - elev. of conduit invert)
-    y1 = h1 - z1;
-    y2 = h2 - z2;
-    y1 = MAX(y1, FUDGE);
-    y2 = MAX(y2, FUDGE);
-
-    // --- flow depths can't exceed full depth of conduit
-    y1 = MIN(y1, xsect->yFull);
-    y2 = MIN(y2, xsect->yFull);
 
     // -- get area from solution at previous time step
     aOld = Conduit[k].a2;
@@ -118,19 +281,21 @@ void  dwflow_findConduitFlow(int j, int steps, double omega, double dt)
     // --- use Courant-modified length instead of conduit's actual length
     length = Conduit[k].modLength;
 
-    // --- find surface area contributions to upstream and downstream nodes
-    //     based on previous iteration's flow estimate
-    findSurfArea(j, qLast, length, &h1, &h2, &y1, &y2);
+    // --- get heads & depths as adjusted by surface area assignment
+    h1 = ends->h1;
+    h2 = ends->h2;
+    y1 = ends->y1;
+    y2 = ends->y2;
 
-    // --- compute area at each end of conduit & hyd. radius at upstream end
-    a1 = getArea(xsect, y1);
-    a2 = getArea(xsect, y2);
-    r1 = getHydRad(xsect, y1);
+    // --- area at each end of conduit & hyd. radius at upstream end
+    a1 = a[0];
+    a2 = a[1];
+    r1 = r[0];
 
-    // --- compute area & hyd. radius at midpoint
+    // --- area & hyd. radius at midpoint
     yMid = 0.5 * (y1 + y2);
-    aMid = getArea(xsect, yMid);
-    rMid = getHydRad(xsect, yMid);
+    aMid = a[2];
+    rMid = r[2];
 
     // --- alternate approach not currently used, but might produce better
     //     Bernoulli energy balance for steady flows
@@ -156,6 +321,7 @@ void  dwflow_findConduitFlow(int j, int steps, double omega, double dt)
         Link[j].newDepth = MIN(yMid, Link[j].xsect.yFull);
         Link[j].newVolume = Conduit[k].a1 * link_getLength(j) * barrels;
         Link[j].newFlow = 0.0;
+        saveLinkState(j);                                                      //(OPENSWMM 5.1.913)
         return;
     }
 
@@ -258,8 +424,8 @@ void  dwflow_findConduitFlow(int j, int steps, double omega, double dt)
 
     // --- do not allow flow out of a dry node
     //     (as suggested by R. Dickinson)
-    if( q >  FUDGE && Node[n1].newDepth <= FUDGE ) q =  FUDGE;
-    if( q < -FUDGE && Node[n2].newDepth <= FUDGE ) q = -FUDGE;
+    if( q >  FUDGE && DwNode.newDepth[n1] <= FUDGE ) q =  FUDGE;               //(OPENSWMM 5.1.913)
+    if( q < -FUDGE && DwNode.newDepth[n2] <= FUDGE ) q = -FUDGE;
 
     // --- save new values of area, flow, depth, & volume
     Conduit[k].a1 = aMid;
@@ -271,6 +437,7 @@ void  dwflow_findConduitFlow(int j, int steps, double omega, double dt)
     Conduit[k].fullState = link_getFullState(a1, a2, xsect->aFull);            //(5.1.008)
     Link[j].newVolume = aMid * link_getLength(j) * barrels;
     Link[j].newFlow = q * barrels;
+    saveLinkState(j);                                                          //(OPENSWMM 5.1.913)
 }
 
 //=============================================================================
@@ -305,8 +472,8 @@ int getFlowClass(int j, double q, double h1, double h2, double y1, double y2,
     z2 = Link[j].offset2;
 
     // --- base offset of an outfall conduit on outfall's depth
-    if ( Node[n1].type == OUTFALL ) z1 = MAX(0.0, (z1 - Node[n1].newDepth));
-    if ( Node[n2].type == OUTFALL ) z2 = MAX(0.0, (z2 - Node[n2].newDepth));
+    if ( DwNode.isOutfall[n1] ) z1 = MAX(0.0, (z1 - DwNode.newDepth[n1]));     //(OPENSWMM 5.1.913)
+    if ( DwNode.isOutfall[n2] ) z2 = MAX(0.0, (z2 - DwNode.newDepth[n2]));
 
     // --- default class is SUBCRITICAL
     flowClass = SUBCRITICAL;
@@ -359,7 +526,7 @@ int getFlowClass(int j, double q, double h1, double h2, double y1, double y2,
     {
         // --- flow classification is UP_DRY if downstream head <
         //     invert of upstream end of conduit
-        if ( h2 < Node[n1].invertElev + Link[j].offset1 ) flowClass = UP_DRY;
+        if ( h2 < DwNode.invertElev[n1] + Link[j].offset1 ) flowClass = UP_DRY;
 
         // --- otherwise, the downstream head will be >= upstream
         //     conduit invert creating a flow reversal and upstream end
@@ -378,7 +545,7 @@ int getFlowClass(int j, double q, double h1, double h2, double y1, double y2,
     {
         // --- flow classification is DN_DRY if upstream head <
         //     invert of downstream end of conduit
-        if ( h1 < Node[n2].invertElev + Link[j].offset2 ) flowClass = DN_DRY;
+        if ( h1 < DwNode.invertElev[n2] + Link[j].offset2 ) flowClass = DN_DRY;
 
         // --- otherwise flow at downstream end should be at critical depth
         //     providing that a downstream offset exists (otherwise
@@ -395,92 +562,117 @@ int getFlowClass(int j, double q, double h1, double h2, double y1, double y2,
 
 //=============================================================================
 
-void findSurfArea(int j, double q, double length, double* h1, double* h2,
-                  double* y1, double* y2)
+void findSurfDepths(int j, TConduitEnds* ends, double yWidth[])
 //
 //  Input:   j  = conduit link index
-//           q  = current conduit flow (cfs)
-//           length = conduit length (ft)
-//           h1 = head at upstream end of conduit (ft)
-//           h2 = head at downstream end of conduit (ft)
-//           y1 = upstream flow depth (ft)
-//           y2 = downstream flow depth (ft)
-//  Output:  updated values of h1, h2, y1, & y2;
-//  Purpose: assigns surface area of conduit to its up and downstream nodes.
+//           ends = heads & flow depths at each end of conduit
+//  Output:  ends = heads & flow depths adjusted for flow classification;
+//           yWidth = depths at which top width is needed at upstream end,
+//                    downstream end and midpoint of conduit (ft)
+//  Purpose: finds a conduit's flow classification and the flow depths
+//           used to assign its surface area to its up and downstream nodes.
+//
+//  NOTE: this is the first half of what was findSurfArea(); the top widths
+//        at the returned depths are passed to setSurfArea().
 //
 {
     int     n1, n2;                    // indexes of upstrm/downstrm nodes
+    double  q;                         // current conduit flow (cfs)
     double  flowDepth1;                // flow depth at upstrm end (ft)
     double  flowDepth2;                // flow depth at downstrm end (ft)
     double  flowDepthMid;              // flow depth at midpt. (ft)
-    double  width1;                    // top width at upstrm end (ft)
-    double  width2;                    // top width at downstrm end (ft)
-    double  widthMid;                  // top width at midpt. (ft)
-    double  surfArea1 = 0.0;           // surface area at upstream node (ft2)
-    double  surfArea2 = 0.0;           // surface area st downstrm node (ft2)
     double  criticalDepth;             // critical flow depth (ft)
     double  normalDepth;               // normal flow depth (ft)
-    double  fasnh;                     // fraction between norm. & crit. depth
     TXsect* xsect = &Link[j].xsect;    // pointer to cross-section data
 
     // --- get node indexes & current flow depths
     n1 = Link[j].node1;
     n2 = Link[j].node2;
-    flowDepth1 = *y1;
-    flowDepth2 = *y2;
+    q = Conduit[Link[j].subIndex].q1;
+    flowDepth1 = ends->y1;
+    flowDepth2 = ends->y2;
 
     normalDepth = (flowDepth1 + flowDepth2) / 2.0;
     criticalDepth = normalDepth;
 
     // --- find conduit's flow classification
-    Link[j].flowClass = getFlowClass(j, q, *h1, *h2, *y1, *y2,
-	                    &criticalDepth, &normalDepth, &fasnh);
+    Link[j].flowClass = getFlowClass(j, q, ends->h1, ends->h2, ends->y1,
+                        ends->y2, &criticalDepth, &normalDepth, &ends->fasnh);
 
-    // --- add conduit's surface area to its end nodes depending on flow class
+    // --- adjust end depths depending on flow class
     switch ( Link[j].flowClass )
     {
-      case SUBCRITICAL:
-        flowDepthMid = 0.5 * (flowDepth1 + flowDepth2);
-        if ( flowDepthMid < FUDGE ) flowDepthMid = FUDGE;
-        width1 =   getWidth(xsect, flowDepth1);
-        width2 =   getWidth(xsect, flowDepth2);
-        widthMid = getWidth(xsect, flowDepthMid);
-        surfArea1 = (width1 + widthMid) * length / 4.;
-        surfArea2 = (widthMid + width2) * length / 4. * fasnh;
-        break;
-
       case UP_CRITICAL:
         flowDepth1 = criticalDepth;
         if ( normalDepth < criticalDepth ) flowDepth1 = normalDepth;
         flowDepth1 = MAX(flowDepth1, FUDGE);
-        *h1 = Node[n1].invertElev + Link[j].offset1 + flowDepth1;
-        flowDepthMid = 0.5 * (flowDepth1 + flowDepth2);
-        if ( flowDepthMid < FUDGE ) flowDepthMid = FUDGE;
-        width2   = getWidth(xsect, flowDepth2);
-        widthMid = getWidth(xsect, flowDepthMid);
-        surfArea2 = (widthMid + width2) * length * 0.5;
+        ends->h1 = DwNode.invertElev[n1] + Link[j].offset1 + flowDepth1;
         break;
 
       case DN_CRITICAL:
         flowDepth2 = criticalDepth;
         if ( normalDepth < criticalDepth ) flowDepth2 = normalDepth;
         flowDepth2 = MAX(flowDepth2, FUDGE);
-        *h2 = Node[n2].invertElev + Link[j].offset2 + flowDepth2;
-        width1 = getWidth(xsect, flowDepth1);
-        flowDepthMid = 0.5 * (flowDepth1 + flowDepth2);
-        if ( flowDepthMid < FUDGE ) flowDepthMid = FUDGE;
-        widthMid = getWidth(xsect, flowDepthMid);
-        surfArea1 = (width1 + widthMid) * length * 0.5;
+        ends->h2 = DwNode.invertElev[n2] + Link[j].offset2 + flowDepth2;
         break;
 
       case UP_DRY:
         flowDepth1 = FUDGE;
-        flowDepthMid = 0.5 * (flowDepth1 + flowDepth2);
-        if ( flowDepthMid < FUDGE ) flowDepthMid = FUDGE;
-        width1 = getWidth(xsect, flowDepth1);
-        width2 = getWidth(xsect, flowDepth2);
-        widthMid = getWidth(xsect, flowDepthMid);
+        break;
+
+      case DN_DRY:
+        flowDepth2 = FUDGE;
+        break;
+    }
+    flowDepthMid = 0.5 * (flowDepth1 + flowDepth2);
+    if ( flowDepthMid < FUDGE ) flowDepthMid = FUDGE;
+
+    yWidth[0] = getWidthDepth(xsect, flowDepth1);
+    yWidth[1] = getWidthDepth(xsect, flowDepth2);
+    yWidth[2] = getWidthDepth(xsect, flowDepthMid);
+    ends->y1 = flowDepth1;
+    ends->y2 = flowDepth2;
+}
+
+//=============================================================================
+
+void setSurfArea(int j, double fasnh, double width[])
+//
+//  Input:   j  = conduit link index
+//           fasnh = fraction between norm. & crit. depth
+//           width = top widths at upstream end, downstream end and
+//                   midpoint of conduit (ft)
+//  Output:  none
+//  Purpose: assigns surface area of conduit to its up and downstream nodes.
+//
+{
+    double  length;                    // conduit length (ft)
+    double  width1 = width[0];         // top width at upstrm end (ft)
+    double  width2 = width[1];         // top width at downstrm end (ft)
+    double  widthMid = width[2];       // top width at midpt. (ft)
+    double  surfArea1 = 0.0;           // surface area at upstream node (ft2)
+    double  surfArea2 = 0.0;           // surface area st downstrm node (ft2)
+
+    // --- use Courant-modified length instead of conduit's actual length
+    length = Conduit[Link[j].subIndex].modLength;
+
+    // --- add conduit's surface area to its end nodes depending on flow class
+    switch ( Link[j].flowClass )
+    {
+      case SUBCRITICAL:
+        surfArea1 = (width1 + widthMid) * length / 4.;
+        surfArea2 = (widthMid + width2) * length / 4. * fasnh;
+        break;
+
+      case UP_CRITICAL:
+        surfArea2 = (widthMid + width2) * length * 0.5;
+        break;
+
+      case DN_CRITICAL:
+        surfArea1 = (width1 + widthMid) * length * 0.5;
+        break;
 
+      case UP_DRY:
         // --- assign avg. surface area of downstream half of conduit
         //     to the downstream node
         surfArea2 = (widthMid + width2) * length / 4.;
@@ -494,13 +686,6 @@ void findSurfArea(int j, double q, double length, double* h1, double* h2,
         break;
 
       case DN_DRY:
-        flowDepth2 = FUDGE;
-        flowDepthMid = 0.5 * (flowDepth1 + flowDepth2);
-        if ( flowDepthMid < FUDGE ) flowDepthMid = FUDGE;
-        width1 = getWidth(xsect, flowDepth1);
-        width2 = getWidth(xsect, flowDepth2);
-        widthMid = getWidth(xsect, flowDepthMid);
-
         // --- assign avg. surface area of upstream half of conduit
         //     to the upstream node
         surfArea1 = (widthMid + width1) * length / 4.;
@@ -520,8 +705,6 @@ void findSurfArea(int j, double q, double length, double* h1, double* h2,
     }
     Link[j].surfArea1 = surfArea1;
     Link[j].surfArea2 = surfArea2;
-    *y1 = flowDepth1;
-    *y2 = flowDepth2;
 }
 
 //=============================================================================
@@ -547,50 +730,19 @@ double findLocalLosses(int j, double a1, double a2, double aMid, double q)
 
 //=============================================================================
 
-double getWidth(TXsect* xsect, double y)
+double getWidthDepth(TXsect* xsect, double y)
 //
 //  Input:   xsect = ptr. to conduit cross section
 //           y     = flow depth (ft)
-//  Output:  returns top width (ft)
-//  Purpose: computes top width of flow surface in conduit.
+//  Output:  returns depth at which to evaluate top width (ft)
+//  Purpose: limits the depth used to find the top width of flow surface
+//           in a closed conduit.
 //
 {
     double yNorm = y/xsect->yFull;
     if ( yNorm > 0.96 &&
          !xsect_isOpen(xsect->type) ) y = 0.96*xsect->yFull;
-    return xsect_getWofY(xsect, y);
-}
-
-//=============================================================================
-
-double getArea(TXsect* xsect, double y)
-//
-//  Input:   xsect = ptr. to conduit cross section
-//           y     = flow depth (ft)
-//  Output:  returns flow area (ft2)
-//  Purpose: computes area of flow cross-section in a conduit.
-//
-{
-    double area;                        // flow area (ft2)
-    y = MIN(y, xsect->yFull);
-    area = xsect_getAofY(xsect, y);
-    return area;
-}
-
-//=============================================================================
-
-double getHydRad(TXsect* xsect, double y)
-//
-//  Input:   xsect = ptr. to conduit cross section
-//           y     = flow depth (ft)
-//  Output:  returns hydraulic radius (ft)
-//  Purpose: computes hydraulic radius of flow cross-section in a conduit.
-//
-{
-    double hRadius;                     // hyd. radius (ft)
-    y = MIN(y, xsect->yFull);
-    hRadius = xsect_getRofY(xsect, y);
-    return hRadius;
+    return y;
 }
 
 //=============================================================================
@@ -612,7 +764,7 @@ double checkNormalFlow(int j, double q, double y1, double y2, double a1,
     int    k = Link[j].subIndex;
     int    n1 = Link[j].node1;
     int    n2 = Link[j].node2;
-    int    hasOutfall = (Node[n1].type == OUTFALL || Node[n2].type == OUTFALL);
+    int    hasOutfall = (DwNode.isOutfall[n1] || DwNode.isOutfall[n2]);
     double qNorm;
     double f1;
 
@@ -645,3 +797,22 @@ double checkNormalFlow(int j, double q, double y1, double y2, double a1,
     }
     return q;
 }
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+void saveLinkState(int j)
+//
+//  Input:   j = link index
+//  Output:  none
+//  Purpose: copies a conduit's newly computed state into the packed
+//           routing state arrays.
+//
+{
+    DwLink.newFlow[j]   = Link[j].newFlow;
+    DwLink.newDepth[j]  = Link[j].newDepth;
+    DwLink.newVolume[j] = Link[j].newVolume;
+    DwLink.froude[j]    = Link[j].froude;
+    DwLink.dqdh[j]      = Link[j].dqdh;
+}
@@ -38,19 +38,51 @@
 //   - Added test for failed memory allocation.
 //   - Fixed illegal array index bug for Ideal Pumps.
 //
+//   OpenSWMM 5.1.913:
+//   - Added an implicit Newton-Raphson solver for node heads as an
+//     alternative to Picard iterations (SOLVER_METHOD option).
+//   - Extended node data and the node & link variables used most by the
+//     routing kernels are now stored as packed arrays (see dynwave.h).
+//   - Node flows from conduits are now accumulated in parallel, with each
+//     node gathering from a list of its attached conduits.
+//   - Searches for the critical link and node time steps are now done in
+//     parallel.
+//   - Added multirate time stepping (MULTIRATE_CLASSES option) where nodes
+//     and links are advanced with power-of-two fractions of the routing
+//     time step according to their own stability criteria.
+//   - After the first trial of a time step, only the region of unconverged
+//     nodes and their immediate neighbors is re-solved.
+//   - Picard iterations can be accelerated by Anderson mixing of the free
+//     surface node depths (SOLVER_ACCELERATION option).
+//   - The first trial of a time step can start from node depths and
+//     conduit flows extrapolated from the previous step's rates of change
+//     (SOLVER_PREDICTOR option).
+//   - Nodes & links are processed in an order that keeps neighbors in the
+//     network close together (see toposort_sortForLocality()).
+//   - Each hydraulically independent component of the network iterates to
+//     convergence on its own, with components solved in parallel when
+//     there are enough of them.
+//   - Conduit flows are updated in blocks of active links so that their
+//     cross section geometry can be found with batch function calls.
+//
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
 #include "headers.h"
+#include <stdlib.h>                                                            //(OPENSWMM 5.1.913)
 #include <malloc.h>
 #include <math.h>
 #include <omp.h>                                                               //(5.1.008)
+#include "smatrix.h"                                                           //(OPENSWMM 5.1.913)
+#include "accel.h"                                                             //(OPENSWMM 5.1.913)
+#include "dynwave.h"                                                           //(OPENSWMM 5.1.913)
 
 //-----------------------------------------------------------------------------
 //     Constants 
 //-----------------------------------------------------------------------------
 static const double MINTIMESTEP =  0.001;   // min. time step (sec)            //(5.1.008)
 static const double OMEGA       =  0.5;     // under-relaxation parameter
+static const double FIXEDHEAD   =  1.0e8;   // Newton coeff. for fixed head    //(OPENSWMM 5.1.913)
 
 //  Constants moved here from project.c  //                                    //(5.1.008)
 const double DEFAULT_SURFAREA  = 12.566; // Min. nodal surface area (~4 ft diam.)
@@ -61,27 +93,122 @@ const int    DEFAULT_MAXTRIALS = 8;      // Max. trials per time step
 //-----------------------------------------------------------------------------
 //  Data Structures
 //-----------------------------------------------------------------------------
-typedef struct 
+typedef struct                         // stored as one array per variable  //(OPENSWMM 5.1.913)
 {
-    char    converged;                 // TRUE if iterations for a node done
-    double  newSurfArea;               // current surface area (ft2)
-    double  oldSurfArea;               // previous surface area (ft2)
-    double  sumdqdh;                   // sum of dqdh from adjoining links
-    double  dYdT;                      // change in depth w.r.t. time (ft/sec)
+    char*   converged;                 // TRUE if iterations for a node done
+    double* newSurfArea;               // current surface area (ft2)
+    double* oldSurfArea;               // previous surface area (ft2)
+    double* sumdqdh;                   // sum of dqdh from adjoining links
+    double* dYdT;                      // change in depth w.r.t. time (ft/sec)
 } TXnode;
 
 //-----------------------------------------------------------------------------
 //  Shared Variables
 //-----------------------------------------------------------------------------
 static double  VariableStep;           // size of variable time step (sec)
-static TXnode* Xnode;                  // extended nodal information
+static TXnode  Xnode;                  // extended nodal information      //(OPENSWMM 5.1.913)
 
 static double  Omega;                  // actual under-relaxation parameter
 static int     Steps;                  // number of Picard iterations
 
+//-----------------------------------------------------------------------------
+//  Exportable variables (shared with dwflow.c)                                //(OPENSWMM 5.1.913)
+//-----------------------------------------------------------------------------
+TDwNodeState  DwNode;                  // packed node routing state
+TDwLinkState  DwLink;                  // packed link routing state
+
+// --- ends of non-dummy conduits attached to each node, listed in order of  //(OPENSWMM 5.1.913)
+//     link index (entry = 2*link for upstream end, 2*link+1 for downstream)
+static int*    ConduitEndStart;        // start of each node's entries
+static int*    ConduitEnds;            // conduit ends attached to nodes
+
+// --- all links attached to each node, listed in order of link index        //(OPENSWMM 5.1.913)
+static int*    NodeLinkStart;          // start of each node's entries
+static int*    NodeLinks;              // links attached to nodes
+
+// --- Newton-Raphson head solver                                             //(OPENSWMM 5.1.913)
+static int*    NodeRow;                // row of each node in head equations
+static double* HeadRhs;                // right hand side of head equations
+static double* HeadChange;             // solution of head equations (ft)
+
+// --- Anderson acceleration of Picard iterations                             //(OPENSWMM 5.1.913)
+static double* AccelX;                 // node depths at start of trial (ft)
+static double* AccelY;                 // accelerated node depths (ft)
+static int*    AccelNodes;             // nodes whose depths are accelerated
+
+// --- predictor of the first trial of a time step                            //(OPENSWMM 5.1.913)
+static double* NodeRate;               // last two rates of change of node depth
+static double* LinkRate;               // last two rates of change of link flow
+
+// --- nodes & links being advanced over the current time step               //(OPENSWMM 5.1.913)
+static int     NumActiveNodes;         // number of active nodes
+static int     NumActiveLinks;         // number of active links
+static int*    ActiveNodes;            // indexes of active nodes
+static int*    ActiveLinks;            // indexes of active links
+static char*   NodeActive;             // TRUE if node is active
+static char*   LinkActive;             // TRUE if link is active
+static int*    AllNodes;               // all nodes in processing order
+static int*    AllLinks;               // all links in processing order
+static int*    NodeRank;               // position of each node in AllNodes
+static int*    LinkRank;               // position of each link in AllLinks
+
+// --- hydraulically independent components of the network                   //(OPENSWMM 5.1.913)
+static int     NumComponents;          // number of components
+static int*    CompNodeStart;          // start of each component in AllNodes
+static int*    CompLinkStart;          // start of each component in AllLinks
+static int     RegionNodeBase;         // where the region buffers of the
+static int     RegionLinkBase;         //   component being solved start
+
+// --- region of unconverged nodes re-solved on later trials                 //(OPENSWMM 5.1.913)
+static int*    RegionNodes[2];         // nodes in region (two buffers)
+static int*    RegionLinks[2];         // links in region (two buffers)
+static char*   NodeInRegion;           // TRUE if node is in region
+static char*   LinkInRegion;           // TRUE if link is in region
+
+// --- the state of a trial is kept by each thread so that independent       //(OPENSWMM 5.1.913)
+//     components can be solved at the same time
+#pragma omp threadprivate(Omega, Steps, NumActiveNodes, NumActiveLinks, \
+                          ActiveNodes, ActiveLinks, RegionNodeBase, \
+                          RegionLinkBase)
+
+// --- multirate time stepping                                                //(OPENSWMM 5.1.913)
+static int     MaxClass;               // finest time step class in use
+static char*   NodeClass;              // time step class of each node
+static char*   LinkClass;              // time step class of each link
+static int     ClassNodeStart[MAXCLASSES+2]; // start of each class's nodes
+static int     ClassLinkStart[MAXCLASSES+2]; // start of each class's links
+static int*    ClassNodes;             // nodes listed by time step class
+static int*    ClassLinks;             // links listed by time step class
+static double* NodeOldState;           // node old states at start of step
+static double* LinkOldState;           // link old states at start of step
+static double* NodeFlowSum;            // volumes passed to nodes by finer links
+static double  ClassStep;              // sub-step of class being advanced (sec)
+static int     StepClass;              // time step class being advanced
+
 //-----------------------------------------------------------------------------
 //  Function declarations
 //-----------------------------------------------------------------------------
+static int    createRoutingState(void);                                        //(OPENSWMM 5.1.913)
+static void   freeRoutingState(void);
+static void   loadRoutingState(void);
+static void   loadLinkState(int link);
+static void   setOutfallDepths(void);
+static void   setActiveObjects(int nNodes, int* nodes, int nLinks, int* links);
+
+static int    advanceStep(double dt);                                          //(OPENSWMM 5.1.913)
+static int    advanceStepClasses(double tStep);
+static int    advanceComponents(double tStep);
+static int    createComponents(void);
+static void   assignStepClasses(double tStep);
+static int    findStepClass(double tStep, double t);
+static int    isSurcharged(int i);
+static void   listStepClasses(void);
+static void   saveOldStates(void);
+static void   setSubStepOldStates(void);
+static void   restoreOldStates(void);
+static void   addFinerLinkFlows(int i);
+static void   sumFinerLinkFlows(double dt);
+
 static void   initRoutingStep(void);
 static void   initNodeStates(void);
 static void   findBypassedLinks();
@@ -93,15 +220,36 @@ static void   findNonConduitFlow(int link, double dt);
 static void   findNonConduitSurfArea(int link);
 static double getModPumpFlow(int link, double q, double dt);
 static void   updateNodeFlows(int link);
+static int    createConduitEnds(void);                                         //(OPENSWMM 5.1.913)
+static int    createNodeLinks(void);
+static void   findActiveRegion(int buffer);
+static int    accelerateNodeDepths(double dt);
+static void   predictStates(double dt);
+static void   saveStateRates(double dt);
+static double getPredictedRate(double* rate);
+static int    compareNodes(const void* a, const void* b);
+static int    compareLinks(const void* a, const void* b);
+static void   gatherConduitFlows(int node);
 
 static int    findNodeDepths(double dt);
 static void   setNodeDepth(int node, double dt);
+static void   saveNodeDepth(int node, int canPond, double dV, double yNew,
+              double dt);
 static double getFloodedDepth(int node, int canPond, double dV, double yNew,
               double yMax, double dt);
 
+static int    createHeadEqns(void);                                            //(OPENSWMM 5.1.913)
+static int    solveNodeHeads(double dt);
+static double getNodeEqnCoeffs(int node, double dt, double* rhs);
+static int    getHeadLimit(int node);
+static void   setNewtonNodeDepth(int node, double dh, double dt);
+
 static double getVariableStep(double maxStep);
 static double getLinkStep(double tMin, int *minLink);
 static double getNodeStep(double tMin, int *minNode);
+static double getCourantStep(int link);                                        //(OPENSWMM 5.1.913)
+static double getDepthChangeStep(int node);
+static void   updateCriticalStep(double t, int i, double* tMin, int* iMin);   //(OPENSWMM 5.1.913)
 
 //=============================================================================
 
@@ -118,10 +266,9 @@ void dynwave_init()
     double z;
 
     VariableStep = 0.0;
-    Xnode = (TXnode *) calloc(Nobjects[NODE], sizeof(TXnode));
 
 ////  Added to release 5.1.011.  ////                                          //(5.1.011)
-    if ( Xnode == NULL )
+    if ( !createRoutingState() )                                               //(OPENSWMM 5.1.913)
     {
         report_writeErrorMsg(ERR_MEMORY,
             " Not enough memory for dynamic wave routing.");
@@ -129,11 +276,47 @@ void dynwave_init()
     }
 //////////////////////////////////////
 
+    // --- all nodes & links start out in the same time step class            //(OPENSWMM 5.1.913)
+    MaxClass = 0;
+    setActiveObjects(Nobjects[NODE], AllNodes, Nobjects[LINK], AllLinks);
+
+    // --- list the conduits & links attached to each node and the
+    //     independent components of the network                              //(OPENSWMM 5.1.913)
+    if ( !createConduitEnds() || !createNodeLinks() || !createComponents() )
+    {
+        report_writeErrorMsg(ERR_MEMORY,
+            " Not enough memory for dynamic wave routing.");
+        return;
+    }
+
+    // --- create the system of node head equations for Newton's method
+    if ( SolverMethod == NEWTON && !createHeadEqns() )                        //(OPENSWMM 5.1.913)
+    {
+        report_writeErrorMsg(ERR_MEMORY,
+            " Not enough memory for dynamic wave routing.");
+        return;
+    }
+
+    // --- open the accelerator of Picard iterations
+    if ( SolverMethod == PICARD && SolverAccel == ANDERSON )                  //(OPENSWMM 5.1.913)
+    {
+        AccelX = (double *) calloc(Nobjects[NODE], sizeof(double));
+        AccelY = (double *) calloc(Nobjects[NODE], sizeof(double));
+        AccelNodes = (int *) calloc(Nobjects[NODE], sizeof(int));
+        if ( (Nobjects[NODE] > 0 && (!AccelX || !AccelY || !AccelNodes)) ||
+             !accel_open(Nobjects[NODE], AccelTerms) )
+        {
+            report_writeErrorMsg(ERR_MEMORY,
+                " Not enough memory for dynamic wave routing.");
+            return;
+        }
+    }
+
     // --- initialize node surface areas & crown elev.
     for (i = 0; i < Nobjects[NODE]; i++ )
     {
-        Xnode[i].newSurfArea = 0.0;
-        Xnode[i].oldSurfArea = 0.0;
+        Xnode.newSurfArea[i] = 0.0;
+        Xnode.oldSurfArea[i] = 0.0;
         Node[i].crownElev = Node[i].invertElev;
     }
 
@@ -149,6 +332,14 @@ void dynwave_init()
         Link[i].flowClass = DRY;
         Link[i].dqdh = 0.0;
     }
+
+    // --- save node properties used by the routing kernels                   //(OPENSWMM 5.1.913)
+    for (i = 0; i < Nobjects[NODE]; i++)
+    {
+        DwNode.invertElev[i] = Node[i].invertElev;
+        DwNode.yCrown[i] = Node[i].crownElev - Node[i].invertElev;
+        DwNode.isOutfall[i] = (Node[i].type == OUTFALL);
+    }
 }
 
 //=============================================================================
@@ -160,7 +351,22 @@ void  dynwave_close()
 //  Purpose: frees memory allocated for dynamic wave routing method.
 //
 {
-    FREE(Xnode);
+    freeRoutingState();                                                        //(OPENSWMM 5.1.913)
+    FREE(ConduitEndStart);
+    FREE(ConduitEnds);
+    FREE(NodeLinkStart);                                                       //(OPENSWMM 5.1.913)
+    FREE(NodeLinks);
+    FREE(CompNodeStart);                                                       //(OPENSWMM 5.1.913)
+    FREE(CompLinkStart);
+    NumComponents = 0;
+    FREE(NodeRow);                                                             //(OPENSWMM 5.1.913)
+    FREE(HeadRhs);
+    FREE(HeadChange);
+    smatrix_close();
+    FREE(AccelX);                                                              //(OPENSWMM 5.1.913)
+    FREE(AccelY);
+    FREE(AccelNodes);
+    accel_close();
 }
 
 //=============================================================================
@@ -209,6 +415,9 @@ double dynwave_getRoutingStep(double fixedStep)
 
     // --- adjust step to be a multiple of a millisecond
     VariableStep = floor(1000.0 * VariableStep) / 1000.0;
+
+    // --- assign nodes & links to multirate time step classes
+    if ( MultirateClasses > 0 ) assignStepClasses(VariableStep);               //(OPENSWMM 5.1.913)
     return VariableStep;
 }
 
@@ -226,18 +435,60 @@ int dynwave_execute(double tStep)
 
     // --- initialize
     if ( ErrorCode ) return 0;
+    loadRoutingState();                                                        //(OPENSWMM 5.1.913)
+
+    // --- advance each class of nodes & links with its own time step
+    if ( MaxClass > 0 ) converged = advanceStepClasses(tStep);                 //(OPENSWMM 5.1.913)
+
+    // --- otherwise advance all nodes & links together
+    else
+    {
+        initRoutingStep();
+        if ( NumComponents > 1 ) converged = advanceComponents(tStep);      //(OPENSWMM 5.1.913)
+        else converged = advanceStep(tStep);
+    }
+    if ( !converged ) NonConvergeCount++;
+
+    //  --- identify any capacity-limited conduits
+    findLimitedLinks();
+    return Steps;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int advanceStep(double dt)
+//
+//  Input:   dt = time step (sec)
+//  Output:  returns TRUE if all active nodes converged
+//  Purpose: iterates the flow and depth solutions of the active nodes and
+//           links over a time step.
+//
+//  Note:    After the first trial only the region of unconverged nodes,
+//           their neighbors and the links attached to them is re-solved.
+//
+{
+    int  converged = FALSE;
+    int  nNodes = NumActiveNodes;
+    int  nLinks = NumActiveLinks;
+    int* nodes = ActiveNodes;
+    int* links = ActiveLinks;
+
     Steps = 0;
-    converged = FALSE;
     Omega = OMEGA;
-    initRoutingStep();
+    if ( AccelX ) accel_reset();
+    if ( NodeRate ) predictStates(dt);
 
     // --- keep iterating until convergence 
     while ( Steps < MaxTrials )
     {
         // --- execute a routing step & check for nodal convergence
         initNodeStates();
-        findLinkFlows(tStep);
-        converged = findNodeDepths(tStep);
+        findLinkFlows(dt);
+        if ( SolverMethod == NEWTON ) converged = solveNodeHeads(dt);
+        else if ( AccelX ) converged = accelerateNodeDepths(dt);
+        else converged = findNodeDepths(dt);
         Steps++;
         if ( Steps > 1 )
         {
@@ -246,33 +497,192 @@ int dynwave_execute(double tStep)
             // --- check if link calculations can be skipped in next step
             findBypassedLinks();
         }
+
+        // --- restrict next trial to the region still being solved
+        if ( !converged ) findActiveRegion(Steps % 2);
     }
-    if ( !converged ) NonConvergeCount++;
+    setActiveObjects(nNodes, nodes, nLinks, links);
+    if ( NodeRate ) saveStateRates(dt);
+    return converged;
+}
 
-    //  --- identify any capacity-limited conduits
-    findLimitedLinks();
-    return Steps;
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int advanceComponents(double tStep)
+//
+//  Input:   tStep = time step (sec)
+//  Output:  returns TRUE if all nodes converged
+//  Purpose: iterates each hydraulically independent component of the
+//           network to convergence on its own.
+//
+//  Note:    When there are at least as many components as threads, each
+//           thread solves whole components with its own trial state.
+//           Otherwise the components are solved one after another, each
+//           using all threads. Each component's solution is the same
+//           either way.
+//
+{
+    int c, m;
+    int converged = TRUE;
+    int maxSteps = 0;
+    int inParallel = ( NumThreads > 1 && NumComponents >= NumThreads );
+
+    // --- each component marks & unmarks its own objects as active
+    setActiveObjects(0, NULL, 0, NULL);
+
+#pragma omp parallel for num_threads(NumThreads) schedule(dynamic) \
+                         private(m) if(inParallel)
+    for (c = 0; c < NumComponents; c++)
+    {
+        RegionNodeBase = CompNodeStart[c];
+        RegionLinkBase = CompLinkStart[c];
+        setActiveObjects(CompNodeStart[c+1] - CompNodeStart[c],
+                         AllNodes + CompNodeStart[c],
+                         CompLinkStart[c+1] - CompLinkStart[c],
+                         AllLinks + CompLinkStart[c]);
+        m = advanceStep(tStep);
+        setActiveObjects(0, NULL, 0, NULL);
+
+        #pragma omp critical
+        {
+            if ( !m ) converged = FALSE;
+            if ( Steps > maxSteps ) maxSteps = Steps;
+        }
+    }
+
+    // --- restore the full set of active objects
+    RegionNodeBase = 0;
+    RegionLinkBase = 0;
+    setActiveObjects(Nobjects[NODE], AllNodes, Nobjects[LINK], AllLinks);
+    Steps = maxSteps;
+    return converged;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+void predictStates(double dt)
+//
+//  Input:   dt = time step (sec)
+//  Output:  none
+//  Purpose: extrapolates the depths of the active nodes and the flows in
+//           the active conduits over a time step from their rates of change
+//           over the previous two steps to provide the first trial's
+//           estimates.
+//
+{
+    int    i, k, m;
+    double r, y, yMax, q, qLast;
+
+    for (m = 0; m < NumActiveNodes; m++)
+    {
+        i = ActiveNodes[m];
+        r = getPredictedRate(&NodeRate[2*i]);
+        if ( DwNode.isOutfall[i] || r == 0.0 || isSurcharged(i) ) continue;
+
+        // --- keep the predicted depth between empty and the max.
+        //     non-flooded depth
+        yMax = Node[i].fullDepth;
+        if ( !AllowPonding || Node[i].pondedArea == 0.0 )
+            yMax += Node[i].surDepth;
+        y = Node[i].newDepth + r * dt;
+        if ( y < 0.0 ) y = 0.0;
+        if ( y > yMax ) y = MAX(yMax, Node[i].newDepth);
+        Node[i].newDepth = y;
+        DwNode.newDepth[i] = y;
+    }
+
+    for (m = 0; m < NumActiveLinks; m++)
+    {
+        i = ActiveLinks[m];
+        r = getPredictedRate(&LinkRate[2*i]);
+        if ( Link[i].type != CONDUIT || r == 0.0 ) continue;
+
+        // --- the conduit flow predicted is the per barrel flow used as
+        //     the previous trial's flow in the first trial
+        k = Link[i].subIndex;
+        qLast = Conduit[k].q1;
+        q = qLast + r / Conduit[k].barrels * dt;
+
+        // --- don't let the prediction reverse the flow direction
+        if ( q * qLast < 0.0 ) q = 0.0;
+        Conduit[k].q1 = q;
+    }
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+void saveStateRates(double dt)
+//
+//  Input:   dt = time step (sec)
+//  Output:  none
+//  Purpose: saves the rates of change of node depths and link flows over a
+//           time step just completed for use by the next step's predictor.
+//
+{
+    int i, m;
+
+    for (m = 0; m < NumActiveNodes; m++)
+    {
+        i = ActiveNodes[m];
+        NodeRate[2*i+1] = NodeRate[2*i];
+        NodeRate[2*i] = (Node[i].newDepth - Node[i].oldDepth) / dt;
+    }
+    for (m = 0; m < NumActiveLinks; m++)
+    {
+        i = ActiveLinks[m];
+        LinkRate[2*i+1] = LinkRate[2*i];
+        LinkRate[2*i] = (Link[i].newFlow - Link[i].oldFlow) / dt;
+    }
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+double getPredictedRate(double* rate)
+//
+//  Input:   rate = rates of change over the last two time steps
+//  Output:  returns the rate of change to extrapolate with
+//  Purpose: returns the smaller of the last two rates of change if they
+//           agree in direction and zero if they don't, so that only a
+//           steady rise or fall is extrapolated.
+//
+{
+    if ( rate[0] * rate[1] <= 0.0 ) return 0.0;
+    if ( fabs(rate[0]) < fabs(rate[1]) ) return rate[0];
+    return rate[1];
 }
 
 //=============================================================================
 
 void   initRoutingStep()
 {
-    int i;
-    for (i = 0; i < Nobjects[NODE]; i++)
+    int i, m;                                                                  //(OPENSWMM 5.1.913)
+    for (m = 0; m < NumActiveNodes; m++)
     {
-        Xnode[i].converged = FALSE;
-        Xnode[i].dYdT = 0.0;
+        i = ActiveNodes[m];
+        Xnode.converged[i] = FALSE;
+        Xnode.dYdT[i] = 0.0;
     }
-    for (i = 0; i < Nobjects[LINK]; i++)
+    for (m = 0; m < NumActiveLinks; m++)
     {
+        i = ActiveLinks[m];
         Link[i].bypassed = FALSE;
         Link[i].surfArea1 = 0.0;
         Link[i].surfArea2 = 0.0;
-    }
 
-    // --- a2 preserves conduit area from solution at last time step
-    for ( i = 0; i < Nlinks[CONDUIT]; i++) Conduit[i].a2 = Conduit[i].a1;
+        // --- a2 preserves conduit area from solution at last time step
+        if ( Link[i].type == CONDUIT )
+        {
+            Conduit[Link[i].subIndex].a2 = Conduit[Link[i].subIndex].a1;
+        }
+    }
 }
 
 //=============================================================================
@@ -284,22 +694,24 @@ void initNodeStates()
 //  Purpose: initializes node's surface area, inflow & outflow
 //
 {
-    int i;
+    int i, m;                                                                  //(OPENSWMM 5.1.913)
 
-    for (i = 0; i < Nobjects[NODE]; i++)
+    for (m = 0; m < NumActiveNodes; m++)
     {
+        i = ActiveNodes[m];
+
         // --- initialize nodal surface area
         if ( AllowPonding )
         {
-            Xnode[i].newSurfArea = node_getPondedArea(i, Node[i].newDepth);
+            Xnode.newSurfArea[i] = node_getPondedArea(i, DwNode.newDepth[i]);
         }
         else
         {
-            Xnode[i].newSurfArea = node_getSurfArea(i, Node[i].newDepth);
+            Xnode.newSurfArea[i] = node_getSurfArea(i, DwNode.newDepth[i]);
         }
-        if ( Xnode[i].newSurfArea < MinSurfArea )
+        if ( Xnode.newSurfArea[i] < MinSurfArea )
         {
-            Xnode[i].newSurfArea = MinSurfArea;
+            Xnode.newSurfArea[i] = MinSurfArea;
         }
 
 ////  Following code section modified for release 5.1.007  ////                //(5.1.007)
@@ -314,7 +726,8 @@ void initNodeStates()
         {    
             Node[i].outflow -= Node[i].newLatFlow;
         }
-        Xnode[i].sumdqdh = 0.0;
+        Xnode.sumdqdh[i] = 0.0;
+        if ( MaxClass > 0 ) addFinerLinkFlows(i);                              //(OPENSWMM 5.1.913)
     }
 }
 
@@ -322,11 +735,12 @@ void initNodeStates()
 
 void   findBypassedLinks()
 {
-    int i;
-    for (i = 0; i < Nobjects[LINK]; i++)
+    int i, m;                                                                  //(OPENSWMM 5.1.913)
+    for (m = 0; m < NumActiveLinks; m++)
     {
-        if ( Xnode[Link[i].node1].converged &&
-             Xnode[Link[i].node2].converged )
+        i = ActiveLinks[m];
+        if ( Xnode.converged[Link[i].node1] &&
+             Xnode.converged[Link[i].node2] )
              Link[i].bypassed = TRUE;
         else Link[i].bypassed = FALSE;
     }
@@ -357,8 +771,8 @@ void  findLimitedLinks()
             // --- check if HGL slope > conduit slope
             n1 = Link[j].node1;
             n2 = Link[j].node2;
-            h1 = Node[n1].newDepth + Node[n1].invertElev;
-            h2 = Node[n2].newDepth + Node[n2].invertElev;
+            h1 = DwNode.newDepth[n1] + DwNode.invertElev[n1];                  //(OPENSWMM 5.1.913)
+            h2 = DwNode.newDepth[n2] + DwNode.invertElev[n2];
             if ( (h1 - h2) > fabs(Conduit[k].slope) * Conduit[k].length )
                 Conduit[k].capacityLimited = TRUE;
         }
@@ -369,31 +783,48 @@ void  findLimitedLinks()
 
 void findLinkFlows(double dt)
 {
-    int i;
-
-    // --- find new flow in each non-dummy conduit
-#pragma omp parallel num_threads(NumThreads)                                   //(5.1.008)
+    int i, m, b, n;                                                            //(OPENSWMM 5.1.913)
+    int conduits[DW_BATCH];
+
+    // --- find new flow in each non-dummy conduit, a block of active
+    //     links at a time
+#pragma omp parallel num_threads(NumThreads) private(i, n, conduits) \
+                     copyin(Omega, Steps, NumActiveNodes, NumActiveLinks, \
+                            ActiveNodes, ActiveLinks)                          //(OPENSWMM 5.1.913)
 {
-    #pragma omp for                                                            //(5.1.008)
-    for ( i = 0; i < Nobjects[LINK]; i++)
+    #pragma omp for private(m)                                                 //(OPENSWMM 5.1.913)
+    for ( b = 0; b < NumActiveLinks; b += DW_BATCH )
     {
-        if ( isTrueConduit(i) && !Link[i].bypassed )
-            dwflow_findConduitFlow(i, Steps, Omega, dt);
+        n = 0;
+        for ( m = b; m < NumActiveLinks && m < b + DW_BATCH; m++ )
+        {
+            i = ActiveLinks[m];
+            if ( isTrueConduit(i) && !Link[i].bypassed ) conduits[n++] = i;
+        }
+        dwflow_findConduitFlows(conduits, n, Steps, Omega, dt);
     }
-}
 
     // --- update inflow/outflows for nodes attached to non-dummy conduits
-    for ( i = 0; i < Nobjects[LINK]; i++)
+    //     (each node gathers from its own conduits so no two threads
+    //     write to the same node)
+    #pragma omp for                                                            //(OPENSWMM 5.1.913)
+    for ( m = 0; m < NumActiveNodes; m++)
     {
-        if ( isTrueConduit(i) ) updateNodeFlows(i);
+        gatherConduitFlows(ActiveNodes[m]);
     }
+}
 
     // --- find new flows for all dummy conduits, pumps & regulators
-    for ( i = 0; i < Nobjects[LINK]; i++)
+    for ( m = 0; m < NumActiveLinks; m++)
     {
+        i = ActiveLinks[m];
         if ( !isTrueConduit(i) )
         {	
-            if ( !Link[i].bypassed ) findNonConduitFlow(i, dt);
+            if ( !Link[i].bypassed )
+            {
+                findNonConduitFlow(i, dt);
+                loadLinkState(i);                                              //(OPENSWMM 5.1.913)
+            }
             updateNodeFlows(i);
         }
     }
@@ -480,7 +911,7 @@ double getModPumpFlow(int i, double q, double dt)
       case TYPE3_PUMP:
          newNetInflow = Node[j].inflow - Node[j].outflow - q;
          netFlowVolume = 0.5 * (Node[j].oldNetInflow + newNetInflow ) * dt;
-         y = Node[j].oldDepth + netFlowVolume / Xnode[j].newSurfArea;
+         y = Node[j].oldDepth + netFlowVolume / Xnode.newSurfArea[j];
          if ( y <= 0.0 ) return Node[j].inflow;
     }
     return q;
@@ -531,7 +962,7 @@ void updateNodeFlows(int i)
     int    barrels = 1;
     int    n1 = Link[i].node1;
     int    n2 = Link[i].node2;
-    double q = Link[i].newFlow;
+    double q = DwLink.newFlow[i];                                              //(OPENSWMM 5.1.913)
     double uniformLossRate = 0.0;
 
     // --- compute any uniform seepage loss from a conduit
@@ -542,62 +973,62 @@ void updateNodeFlows(int i)
         barrels = Conduit[k].barrels;
     }
 
-    // --- update total inflow & outflow at upstream/downstream nodes
-    if ( q >= 0.0 )
+    // --- update upstream node if it is being advanced                       //(OPENSWMM 5.1.913)
+    if ( NodeActive[n1] )
     {
-        Node[n1].outflow += q + uniformLossRate;
-        Node[n2].inflow  += q;
+        if ( q >= 0.0 ) Node[n1].outflow += q + uniformLossRate;
+        else            Node[n1].inflow  -= q;
+        Xnode.newSurfArea[n1] += Link[i].surfArea1 * barrels;
+        Xnode.sumdqdh[n1] += DwLink.dqdh[i];
     }
-    else
-    {
-        Node[n1].inflow   -= q;
-        Node[n2].outflow  -= q - uniformLossRate;
-    }
-
-    // --- add surf. area contributions to upstream/downstream nodes
-    Xnode[Link[i].node1].newSurfArea += Link[i].surfArea1 * barrels;
-    Xnode[Link[i].node2].newSurfArea += Link[i].surfArea2 * barrels;
 
-    // --- update summed value of dqdh at each end node
-    Xnode[Link[i].node1].sumdqdh += Link[i].dqdh;
-    if ( Link[i].type == PUMP )
+    // --- update downstream node if it is being advanced
+    if ( NodeActive[n2] )
     {
-        k = Link[i].subIndex;
-        if ( Pump[k].type != TYPE4_PUMP )                                      //(5.1.011)
+        if ( q >= 0.0 ) Node[n2].inflow  += q;
+        else            Node[n2].outflow -= q - uniformLossRate;
+        Xnode.newSurfArea[n2] += Link[i].surfArea2 * barrels;
+        if ( Link[i].type == PUMP )
         {
-            Xnode[n2].sumdqdh += Link[i].dqdh;
+            k = Link[i].subIndex;
+            if ( Pump[k].type != TYPE4_PUMP )                                  //(5.1.011)
+            {
+                Xnode.sumdqdh[n2] += DwLink.dqdh[i];
+            }
         }
+        else Xnode.sumdqdh[n2] += DwLink.dqdh[i];
     }
-    else Xnode[n2].sumdqdh += Link[i].dqdh;
 }
 
 //=============================================================================
 
 int findNodeDepths(double dt)
 {
-    int i;
+    int i, m;                                                                  //(OPENSWMM 5.1.913)
     int converged;      // convergence flag
     double yOld;        // previous node depth (ft)
 
     // --- compute outfall depths based on flow in connecting link
-    for ( i = 0; i < Nobjects[LINK]; i++ ) link_setOutfallDepth(i);
+    setOutfallDepths();                                                        //(OPENSWMM 5.1.913)
 
     // --- compute new depth for all non-outfall nodes and determine if
     //     depth change from previous iteration is below tolerance
     converged = TRUE;
-#pragma omp parallel num_threads(NumThreads)                                   //(5.1.008)
+#pragma omp parallel num_threads(NumThreads) \
+                     copyin(Steps, Omega, NumActiveNodes, ActiveNodes)         //(OPENSWMM 5.1.913)
 {
-    #pragma omp for private(yOld)                                              //(5.1.008)
-    for ( i = 0; i < Nobjects[NODE]; i++ )
+    #pragma omp for private(i, yOld)                                           //(5.1.008)
+    for ( m = 0; m < NumActiveNodes; m++ )
     {
-        if ( Node[i].type == OUTFALL ) continue;
-        yOld = Node[i].newDepth;
+        i = ActiveNodes[m];                                                    //(OPENSWMM 5.1.913)
+        if ( DwNode.isOutfall[i] ) continue;
+        yOld = DwNode.newDepth[i];
         setNodeDepth(i, dt);
-        Xnode[i].converged = TRUE;
-        if ( fabs(yOld - Node[i].newDepth) > HeadTol )
+        Xnode.converged[i] = TRUE;
+        if ( fabs(yOld - DwNode.newDepth[i]) > HeadTol )
         {
             converged = FALSE;
-            Xnode[i].converged = FALSE;
+            Xnode.converged[i] = FALSE;
         }
     }
 }                                                                              //(5.1.008)
@@ -606,6 +1037,62 @@ int findNodeDepths(double dt)
 
 //=============================================================================
 
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int accelerateNodeDepths(double dt)
+//
+//  Input:   dt = time step (sec)
+//  Output:  returns TRUE if depth change at all active nodes is below tolerance
+//  Purpose: finds new node depths as findNodeDepths() does and then
+//           extrapolates the depths of free surface nodes from the
+//           history of the current step's trials (Anderson acceleration).
+//
+{
+    int    i, m, n = 0;
+    int    converged;
+    double y, yMax;
+
+    // --- save the depths the trial started from
+    for ( m = 0; m < NumActiveNodes; m++ )
+    {
+        i = ActiveNodes[m];
+        AccelX[i] = DwNode.newDepth[i];
+    }
+
+    // --- make a regular Picard update of the depths
+    converged = findNodeDepths(dt);
+
+    // --- only nodes with a free water surface are accelerated
+    for ( m = 0; m < NumActiveNodes; m++ )
+    {
+        i = ActiveNodes[m];
+        if ( DwNode.isOutfall[i] || Node[i].overflow > 0.0 ||
+             isSurcharged(i) ) continue;
+        AccelY[i] = DwNode.newDepth[i];
+        AccelNodes[n++] = i;
+    }
+    accel_mix(n, AccelNodes, AccelX, AccelY);
+
+    // --- save accelerated depths that stay within the free surface range
+    for ( m = 0; m < n; m++ )
+    {
+        i = AccelNodes[m];
+        y = AccelY[i];
+        if ( y == DwNode.newDepth[i] ) continue;
+        if ( Node[i].type == STORAGE ) yMax = Node[i].fullDepth;
+        else yMax = DwNode.yCrown[i];
+        if ( y < 0.0 ) y = 0.0;
+        if ( y >= yMax ) continue;
+        Node[i].newVolume = node_getVolume(i, y);
+        Xnode.dYdT[i] = fabs(y - Node[i].oldDepth) / dt;
+        Node[i].newDepth = y;
+        DwNode.newDepth[i] = y;
+    }
+    return converged;
+}
+
+//=============================================================================
+
 void setNodeDepth(int i, double dt)
 //
 //  Input:   i  = node index
@@ -619,7 +1106,6 @@ void setNodeDepth(int i, double dt)
     double  dQ;                        // inflow minus outflow at node (cfs)
     double  dV;                        // change in node volume (ft3)
     double  dy;                        // change in node depth (ft)
-    double  yMax;                      // max. depth at node (ft)
     double  yOld;                      // node depth at previous time step (ft)
     double  yLast;                     // previous node depth (ft)
     double  yNew;                      // new node depth (ft)
@@ -638,7 +1124,7 @@ void setNodeDepth(int i, double dt)
     yOld = Node[i].oldDepth;
     yLast = Node[i].newDepth;
     Node[i].overflow = 0.0;
-    surfArea = Xnode[i].newSurfArea;
+    surfArea = Xnode.newSurfArea[i];
 
     // --- determine average net flow volume into node over the time step
     dQ = Node[i].inflow - Node[i].outflow;
@@ -651,7 +1137,7 @@ void setNodeDepth(int i, double dt)
         yNew = yOld + dy;
 
         // --- save non-ponded surface area for use in surcharge algorithm     //(5.1.002)
-        if ( !isPonded ) Xnode[i].oldSurfArea = surfArea;                      //(5.1.002)
+        if ( !isPonded ) Xnode.oldSurfArea[i] = surfArea;                      //(5.1.002)
 
         // --- apply under-relaxation to new depth estimate
         if ( Steps > 0 )
@@ -675,12 +1161,12 @@ void setNodeDepth(int i, double dt)
 
         // --- allow surface area from last non-surcharged condition
         //     to influence dqdh if depth close to crown depth
-        denom = Xnode[i].sumdqdh;
+        denom = Xnode.sumdqdh[i];
         if ( yLast < 1.25 * yCrown )
         {
             f = (yLast - yCrown) / yCrown;
-            denom += (Xnode[i].oldSurfArea/dt -
-                      Xnode[i].sumdqdh) * exp(-15.0 * f);
+            denom += (Xnode.oldSurfArea[i]/dt -
+                      Xnode.sumdqdh[i]) * exp(-15.0 * f);
         }
 
         // --- compute new estimate of node depth
@@ -694,6 +1180,25 @@ void setNodeDepth(int i, double dt)
             yNew = Node[i].fullDepth + FUDGE;
     }
 
+    // --- save new depth, volume & overflow for node
+    saveNodeDepth(i, canPond, dV, yNew, dt);
+}
+
+//=============================================================================
+
+void saveNodeDepth(int i, int canPond, double dV, double yNew, double dt)
+//
+//  Input:   i  = node index
+//           canPond = TRUE if water can pond over node
+//           dV = change in volume over time step (ft3)
+//           yNew = new estimate of node depth (ft)
+//           dt = time step (sec)
+//  Output:  none
+//  Purpose: saves a node's new depth after checking for flooding.
+//
+{
+    double  yMax;                      // max. depth at node (ft)
+
     // --- depth cannot be negative
     if ( yNew < 0 ) yNew = 0.0;
 
@@ -709,10 +1214,11 @@ void setNodeDepth(int i, double dt)
     else Node[i].newVolume = node_getVolume(i, yNew);
 
     // --- compute change in depth w.r.t. time
-    Xnode[i].dYdT = fabs(yNew - yOld) / dt;
+    Xnode.dYdT[i] = fabs(yNew - Node[i].oldDepth) / dt;
 
     // --- save new depth for node
     Node[i].newDepth = yNew;
+    DwNode.newDepth[i] = yNew;                                                 //(OPENSWMM 5.1.913)
 }
 
 //=============================================================================
@@ -750,126 +1256,1294 @@ double getFloodedDepth(int i, int canPond, double dV, double yNew,
 
 //=============================================================================
 
-double getVariableStep(double maxStep)
+////  New functions added to release 5.1.913.  ////                            //(OPENSWMM 5.1.913)
+
+int createRoutingState()
 //
-//  Input:   maxStep = user-supplied max. time step (sec)
-//  Output:  returns time step (sec)
-//  Purpose: finds time step that satisfies stability criterion but
-//           is no greater than the user-supplied max. time step.
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: allocates the packed arrays of node and link routing state.
 //
 {
-    int    minLink = -1;                // index of link w/ min. time step
-    int    minNode = -1;                // index of node w/ min. time step
-    double tMin;                        // allowable time step (sec)
-    double tMinLink;                    // allowable time step for links (sec)
-    double tMinNode;                    // allowable time step for nodes (sec)
-
-    // --- find stable time step for links & then nodes
-    tMin = maxStep;
-    tMinLink = getLinkStep(tMin, &minLink);
-    tMinNode = getNodeStep(tMinLink, &minNode);
-
-    // --- use smaller of the link and node time step
-    tMin = tMinLink;
-    if ( tMinNode < tMin )
+    int i;
+    int nNodes = Nobjects[NODE];
+    int nLinks = Nobjects[LINK];
+
+    Xnode.converged   = (char *)   calloc(nNodes, sizeof(char));
+    Xnode.newSurfArea = (double *) calloc(nNodes, sizeof(double));
+    Xnode.oldSurfArea = (double *) calloc(nNodes, sizeof(double));
+    Xnode.sumdqdh     = (double *) calloc(nNodes, sizeof(double));
+    Xnode.dYdT        = (double *) calloc(nNodes, sizeof(double));
+    DwNode.newDepth   = (double *) calloc(nNodes, sizeof(double));
+    DwNode.invertElev = (double *) calloc(nNodes, sizeof(double));
+    DwNode.yCrown     = (double *) calloc(nNodes, sizeof(double));
+    DwNode.isOutfall  = (char *)   calloc(nNodes, sizeof(char));
+    DwLink.newFlow    = (double *) calloc(nLinks, sizeof(double));
+    DwLink.newDepth   = (double *) calloc(nLinks, sizeof(double));
+    DwLink.newVolume  = (double *) calloc(nLinks, sizeof(double));
+    DwLink.froude     = (double *) calloc(nLinks, sizeof(double));
+    DwLink.dqdh       = (double *) calloc(nLinks, sizeof(double));
+    NodeActive        = (char *)   calloc(nNodes, sizeof(char));
+    LinkActive        = (char *)   calloc(nLinks, sizeof(char));
+    AllNodes          = (int *)    calloc(nNodes, sizeof(int));
+    AllLinks          = (int *)    calloc(nLinks, sizeof(int));
+    NodeRank          = (int *)    calloc(nNodes, sizeof(int));
+    LinkRank          = (int *)    calloc(nLinks, sizeof(int));
+    NodeClass         = (char *)   calloc(nNodes, sizeof(char));
+    LinkClass         = (char *)   calloc(nLinks, sizeof(char));
+    ClassNodes        = (int *)    calloc(nNodes, sizeof(int));
+    ClassLinks        = (int *)    calloc(nLinks, sizeof(int));
+    RegionNodes[0]    = (int *)    calloc(2*nNodes, sizeof(int));
+    RegionLinks[0]    = (int *)    calloc(2*nLinks, sizeof(int));
+    NodeInRegion      = (char *)   calloc(nNodes, sizeof(char));
+    LinkInRegion      = (char *)   calloc(nLinks, sizeof(char));
+    if ( SolverPredictor )
     {
-        tMin = tMinNode ;
-        minLink = -1;
+        NodeRate      = (double *) calloc(2*nNodes, sizeof(double));
+        LinkRate      = (double *) calloc(2*nLinks, sizeof(double));
+        if ( (nNodes > 0 && !NodeRate) || (nLinks > 0 && !LinkRate) )
+            return FALSE;
+    }
+    if ( MultirateClasses > 0 )
+    {
+        NodeOldState  = (double *) calloc(3*nNodes, sizeof(double));
+        LinkOldState  = (double *) calloc(5*nLinks, sizeof(double));
+        NodeFlowSum   = (double *) calloc(3*nNodes, sizeof(double));
+        if ( (nNodes > 0 && (!NodeOldState || !NodeFlowSum)) ||
+             (nLinks > 0 && !LinkOldState) ) return FALSE;
     }
 
-    // --- update count of times the minimum node or link was critical
-    stats_updateCriticalTimeCount(minNode, minLink);
+    if ( nNodes > 0 &&
+         ( !Xnode.converged || !Xnode.newSurfArea || !Xnode.oldSurfArea ||
+           !Xnode.sumdqdh || !Xnode.dYdT || !DwNode.newDepth ||
+           !DwNode.invertElev || !DwNode.yCrown || !DwNode.isOutfall ||
+           !NodeActive || !AllNodes || !NodeRank || !NodeClass || !ClassNodes ||
+           !RegionNodes[0] || !NodeInRegion ) )
+        return FALSE;
+    if ( nLinks > 0 &&
+         ( !DwLink.newFlow || !DwLink.newDepth || !DwLink.newVolume ||
+           !DwLink.froude || !DwLink.dqdh || !LinkActive || !AllLinks ||
+           !LinkRank ||
+           !LinkClass || !ClassLinks || !RegionLinks[0] || !LinkInRegion ) )
+        return FALSE;
+    RegionNodes[1] = RegionNodes[0] + nNodes;
+    RegionLinks[1] = RegionLinks[0] + nLinks;
+    for (i = 0; i < nNodes; i++) AllNodes[i] = i;
+    for (i = 0; i < nLinks; i++) AllLinks[i] = i;
+    return TRUE;
+}
 
-    // --- don't let time step go below an absolute minimum
-    if ( tMin < MinRouteStep ) tMin = MinRouteStep;                            //(5.1.008)
-    return tMin;
+//=============================================================================
+
+void freeRoutingState()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the packed arrays of node and link routing state.
+//
+{
+    FREE(Xnode.converged);
+    FREE(Xnode.newSurfArea);
+    FREE(Xnode.oldSurfArea);
+    FREE(Xnode.sumdqdh);
+    FREE(Xnode.dYdT);
+    FREE(DwNode.newDepth);
+    FREE(DwNode.invertElev);
+    FREE(DwNode.yCrown);
+    FREE(DwNode.isOutfall);
+    FREE(DwLink.newFlow);
+    FREE(DwLink.newDepth);
+    FREE(DwLink.newVolume);
+    FREE(DwLink.froude);
+    FREE(DwLink.dqdh);
+    FREE(NodeActive);
+    FREE(LinkActive);
+    FREE(AllNodes);
+    FREE(AllLinks);
+    FREE(NodeRank);
+    FREE(LinkRank);
+    FREE(NodeClass);
+    FREE(LinkClass);
+    FREE(ClassNodes);
+    FREE(ClassLinks);
+    FREE(RegionNodes[0]);
+    FREE(RegionLinks[0]);
+    FREE(NodeInRegion);
+    FREE(LinkInRegion);
+    FREE(NodeOldState);
+    FREE(LinkOldState);
+    FREE(NodeFlowSum);
+    FREE(NodeRate);
+    FREE(LinkRate);
+    NumActiveNodes = 0;
+    NumActiveLinks = 0;
 }
 
 //=============================================================================
 
-double getLinkStep(double tMin, int *minLink)
+void loadRoutingState()
 //
-//  Input:   tMin = critical time step found so far (sec)
-//  Output:  minLink = index of link with critical time step;
-//           returns critical time step (sec)
-//  Purpose: finds critical time step for conduits based on Courant criterion.
+//  Input:   none
+//  Output:  none
+//  Purpose: copies the current node and link state into the packed arrays
+//           used by the routing kernels.
 //
 {
-    int    i;                           // link index
-    int    k;                           // conduit index
-    double q;                           // conduit flow (cfs)
-    double t;                           // time step (sec)
-    double tLink = tMin;                // critical link time step (sec)
+    int i;
 
-    // --- examine each conduit link
-    for ( i = 0; i < Nobjects[LINK]; i++ )
+    for (i = 0; i < Nobjects[NODE]; i++)
     {
-        if ( Link[i].type == CONDUIT )
-        {
-            // --- skip conduits with negligible flow, area or Fr
-            k = Link[i].subIndex;
-            q = fabs(Link[i].newFlow) / Conduit[k].barrels;
-            if ( q <= 0.05 * Link[i].qFull
-            ||   Conduit[k].a1 <= FUDGE
-            ||   Link[i].froude <= 0.01 
-               ) continue;
-
-            // --- compute time step to satisfy Courant condition
-            t = Link[i].newVolume / Conduit[k].barrels / q;
-            t = t * Conduit[k].modLength / link_getLength(i);
-            t = t * Link[i].froude / (1.0 + Link[i].froude) * CourantFactor;
-
-            // --- update critical link time step
-            if ( t < tLink )
-            {
-                tLink = t;
-                *minLink = i;
-            }
-        }
+        DwNode.newDepth[i] = Node[i].newDepth;
     }
-    return tLink;
+    for (i = 0; i < Nobjects[LINK]; i++) loadLinkState(i);
 }
 
 //=============================================================================
 
-double getNodeStep(double tMin, int *minNode)
+void loadLinkState(int i)
 //
-//  Input:   tMin = critical time step found so far (sec)
-//  Output:  minNode = index of node with critical time step;
-//           returns critical time step (sec)
-//  Purpose: finds critical time step for nodes based on max. allowable
-//           projected change in depth.
+//  Input:   i = link index
+//  Output:  none
+//  Purpose: copies a link's current state into the packed arrays used by
+//           the routing kernels.
 //
 {
-    int    i;                           // node index
-    double maxDepth;                    // max. depth allowed at node (ft)
-    double dYdT;                        // change in depth per unit time (ft/sec)
-    double t1;                          // time needed to reach depth limit (sec)
-    double tNode = tMin;                // critical node time step (sec)
-
-    // --- find smallest time so that estimated change in nodal depth
-    //     does not exceed safety factor * maxdepth
-    for ( i = 0; i < Nobjects[NODE]; i++ )
-    {
-        // --- see if node can be skipped
-        if ( Node[i].type == OUTFALL ) continue;
-        if ( Node[i].newDepth <= FUDGE) continue;
-        if ( Node[i].newDepth  + FUDGE >=
-             Node[i].crownElev - Node[i].invertElev ) continue;
+    DwLink.newFlow[i]   = Link[i].newFlow;
+    DwLink.newDepth[i]  = Link[i].newDepth;
+    DwLink.newVolume[i] = Link[i].newVolume;
+    DwLink.froude[i]    = Link[i].froude;
+    DwLink.dqdh[i]      = Link[i].dqdh;
+}
 
-        // --- define max. allowable depth change using crown elevation
-        maxDepth = (Node[i].crownElev - Node[i].invertElev) * 0.25;
-        if ( maxDepth < FUDGE ) continue;
-        dYdT = Xnode[i].dYdT;
-        if (dYdT < FUDGE ) continue;
+//=============================================================================
 
+int createConduitEnds()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: lists the ends of the non-dummy conduits attached to each node.
+//
+{
+    int i, j, n;
+    int nNodes = Nobjects[NODE];
+
+    ConduitEndStart = (int *) calloc(nNodes+1, sizeof(int));
+    if ( ConduitEndStart == NULL ) return FALSE;
+
+    // --- count the conduit ends at each node
+    for (j = 0; j < Nobjects[LINK]; j++)
+    {
+        if ( !isTrueConduit(j) ) continue;
+        ConduitEndStart[Link[j].node1+1]++;
+        ConduitEndStart[Link[j].node2+1]++;
+    }
+    for (i = 0; i < nNodes; i++)
+        ConduitEndStart[i+1] += ConduitEndStart[i];
+
+    // --- fill in each node's list in order of link index
+    ConduitEnds = (int *) calloc(ConduitEndStart[nNodes]+1, sizeof(int));
+    if ( ConduitEnds == NULL ) return FALSE;
+    for (j = 0; j < Nobjects[LINK]; j++)
+    {
+        if ( !isTrueConduit(j) ) continue;
+        n = Link[j].node1;
+        ConduitEnds[ConduitEndStart[n]++] = 2*j;
+        n = Link[j].node2;
+        ConduitEnds[ConduitEndStart[n]++] = 2*j + 1;
+    }
+    for (i = nNodes; i > 0; i--) ConduitEndStart[i] = ConduitEndStart[i-1];
+    ConduitEndStart[0] = 0;
+    return TRUE;
+}
+
+//=============================================================================
+
+int createNodeLinks()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: lists the links attached to each node.
+//
+{
+    int i, j;
+    int nNodes = Nobjects[NODE];
+
+    NodeLinkStart = (int *) calloc(nNodes+1, sizeof(int));
+    if ( NodeLinkStart == NULL ) return FALSE;
+
+    // --- count the links attached to each node
+    for (j = 0; j < Nobjects[LINK]; j++)
+    {
+        NodeLinkStart[Link[j].node1+1]++;
+        NodeLinkStart[Link[j].node2+1]++;
+    }
+    for (i = 0; i < nNodes; i++)
+        NodeLinkStart[i+1] += NodeLinkStart[i];
+
+    // --- fill in each node's list in order of link index
+    NodeLinks = (int *) calloc(NodeLinkStart[nNodes]+1, sizeof(int));
+    if ( NodeLinks == NULL ) return FALSE;
+    for (j = 0; j < Nobjects[LINK]; j++)
+    {
+        NodeLinks[NodeLinkStart[Link[j].node1]++] = j;
+        NodeLinks[NodeLinkStart[Link[j].node2]++] = j;
+    }
+    for (i = nNodes; i > 0; i--) NodeLinkStart[i] = NodeLinkStart[i-1];
+    NodeLinkStart[0] = 0;
+    return TRUE;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int createComponents()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: puts nodes & links in an order that keeps neighbors together
+//           and finds where each independent component of the network
+//           starts in that order.
+//
+{
+    int  i, m, c;
+    int  nNodes = Nobjects[NODE];
+    int  nLinks = Nobjects[LINK];
+    int* component;
+
+    // --- order nodes & links by component, keeping neighbors together
+    component = (int *) calloc(nNodes+1, sizeof(int));
+    if ( component == NULL ) return FALSE;
+    NumComponents = toposort_sortForLocality(AllNodes, AllLinks, component);
+    for (m = 0; m < nNodes; m++) NodeRank[AllNodes[m]] = m;
+    for (m = 0; m < nLinks; m++) LinkRank[AllLinks[m]] = m;
+
+    // --- find where each component's nodes & links start
+    CompNodeStart = (int *) calloc(NumComponents+1, sizeof(int));
+    CompLinkStart = (int *) calloc(NumComponents+1, sizeof(int));
+    if ( CompNodeStart == NULL || CompLinkStart == NULL )
+    {
+        FREE(component);
+        return FALSE;
+    }
+    for (i = 0; i < nNodes; i++) CompNodeStart[component[i]+1]++;
+    for (i = 0; i < nLinks; i++) CompLinkStart[component[Link[i].node1]+1]++;
+    for (c = 0; c < NumComponents; c++)
+    {
+        CompNodeStart[c+1] += CompNodeStart[c];
+        CompLinkStart[c+1] += CompLinkStart[c];
+    }
+    FREE(component);
+
+    // --- components are solved separately only by Picard iterations
+    //     without acceleration, whose state is kept by each thread
+    if ( SolverMethod != PICARD || SolverAccel != NO_ACCEL ) NumComponents = 1;
+    return TRUE;
+}
+
+//=============================================================================
+
+void gatherConduitFlows(int i)
+//
+//  Input:   i = node index
+//  Output:  none
+//  Purpose: adds the flow, surface area and dqdh of each non-dummy conduit
+//           attached to a node to the node's totals.
+//
+//  Note:    contributions are added in the same order as updateNodeFlows()
+//           would add them when called for each conduit in turn, so the
+//           totals do not depend on the number of threads used. The
+//           flow of a conduit that is not being advanced is added to the
+//           node by addFinerLinkFlows() instead.
+//
+{
+    int    m, j, k;
+    double q, uniformLossRate, barrels;
+
+    for (m = ConduitEndStart[i]; m < ConduitEndStart[i+1]; m++)
+    {
+        j = ConduitEnds[m] / 2;
+        k = Link[j].subIndex;
+        q = DwLink.newFlow[j];
+        uniformLossRate = Conduit[k].evapLossRate + Conduit[k].seepLossRate;
+        barrels = Conduit[k].barrels;
+
+        // --- upstream end of conduit
+        if ( ConduitEnds[m] % 2 == 0 )
+        {
+            Xnode.newSurfArea[i] += Link[j].surfArea1 * barrels;
+            if ( !LinkActive[j] ) continue;
+            if ( q >= 0.0 ) Node[i].outflow += q + uniformLossRate;
+            else            Node[i].inflow  -= q;
+        }
+
+        // --- downstream end of conduit
+        else
+        {
+            Xnode.newSurfArea[i] += Link[j].surfArea2 * barrels;
+            if ( !LinkActive[j] ) continue;
+            if ( q >= 0.0 ) Node[i].inflow  += q;
+            else            Node[i].outflow -= q - uniformLossRate;
+        }
+        Xnode.sumdqdh[i] += DwLink.dqdh[j];
+    }
+}
+
+//=============================================================================
+
+void setOutfallDepths()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: sets the depth at each outfall node based on the flow in its
+//           connecting link.
+//
+{
+    int i, k, m;
+
+    // --- an outfall being advanced takes its depth from its connecting
+    //     link even if that link's flow is not being updated
+    for ( m = 0; m < NumActiveNodes; m++ )
+    {
+        i = ActiveNodes[m];
+        if ( !DwNode.isOutfall[i] ) continue;
+        for ( k = NodeLinkStart[i]; k < NodeLinkStart[i+1]; k++ )
+            link_setOutfallDepth(NodeLinks[k]);
+        DwNode.newDepth[i] = Node[i].newDepth;
+    }
+}
+
+//=============================================================================
+
+int createHeadEqns()
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: creates the sparse system of equations solved for the change
+//           in head at each non-outfall node under Newton's method.
+//
+{
+    int  i, n;
+    int* row1;
+    int* row2;
+    int  result;
+
+    // --- assign an equation row to each node whose head is not fixed
+    NodeRow = (int *) calloc(Nobjects[NODE], sizeof(int));
+    if ( NodeRow == NULL ) return FALSE;
+    n = 0;
+    for (i = 0; i < Nobjects[NODE]; i++)
+    {
+        if ( Node[i].type == OUTFALL ) NodeRow[i] = -1;
+        else NodeRow[i] = n++;
+    }
+    HeadRhs = (double *) calloc(n+1, sizeof(double));
+    HeadChange = (double *) calloc(n+1, sizeof(double));
+    if ( HeadRhs == NULL || HeadChange == NULL ) return FALSE;
+
+    // --- each link couples the equations of its end nodes
+    //     (pump flow does not depend on the head difference across it,
+    //     so pumps contribute to the diagonal only)
+    row1 = (int *) calloc(Nobjects[LINK]+1, sizeof(int));
+    row2 = (int *) calloc(Nobjects[LINK]+1, sizeof(int));
+    if ( row1 == NULL || row2 == NULL )
+    {
+        FREE(row1);
+        FREE(row2);
+        return FALSE;
+    }
+    for (i = 0; i < Nobjects[LINK]; i++)
+    {
+        row1[i] = NodeRow[Link[i].node1];
+        row2[i] = NodeRow[Link[i].node2];
+        if ( Link[i].type == PUMP ) row1[i] = -1;
+    }
+    result = smatrix_open(n, Nobjects[LINK], row1, row2);
+    free(row1);
+    free(row2);
+    return result;
+}
+
+//=============================================================================
+
+int solveNodeHeads(double dt)
+//
+//  Input:   dt = time step (sec)
+//  Output:  returns TRUE if all node depths have converged
+//  Purpose: updates node depths by solving the linearized node continuity
+//           equations for the Newton-Raphson change in node heads.
+//
+//  Note:    The continuity residual at each node and its derivatives with
+//           respect to node heads are built from the dqdh terms found for
+//           each link in findLinkFlows() and summed in updateNodeFlows().
+//
+{
+    int    i, j, k, n1, n2;
+    int    converged;
+    double yLast;
+
+    // --- compute outfall depths based on flow in connecting link
+    setOutfallDepths();                                                        //(OPENSWMM 5.1.913)
+
+    // --- add each node's continuity equation to the system
+    smatrix_clear();
+    for (i = 0; i < Nobjects[NODE]; i++)
+    {
+        k = NodeRow[i];
+        if ( k < 0 ) continue;
+        smatrix_addDiag(k, getNodeEqnCoeffs(i, dt, &HeadRhs[k]));
+    }
+
+    // --- add coupling between nodes joined by links
+    for (j = 0; j < Nobjects[LINK]; j++)
+    {
+        if ( Link[j].type == PUMP ) continue;
+        n1 = NodeRow[Link[j].node1];
+        n2 = NodeRow[Link[j].node2];
+        if ( n1 < 0 || n2 < 0 ) continue;
+        smatrix_addOffDiag(n1, n2, -0.5 * Link[j].dqdh);
+    }
+
+    // --- fall back to a Picard update if the system can't be solved
+    if ( !smatrix_solve(HeadRhs, HeadChange) ) return findNodeDepths(dt);
+
+    // --- update node depths & check for convergence
+    converged = TRUE;
+    for (i = 0; i < Nobjects[NODE]; i++)
+    {
+        k = NodeRow[i];
+        if ( k < 0 || !NodeActive[i] ) continue;
+        yLast = Node[i].newDepth;
+        setNewtonNodeDepth(i, HeadChange[k], dt);
+        Xnode.converged[i] = TRUE;
+        if ( fabs(yLast - Node[i].newDepth) > HeadTol )
+        {
+            converged = FALSE;
+            Xnode.converged[i] = FALSE;
+        }
+    }
+    return converged;
+}
+
+//=============================================================================
+
+double getNodeEqnCoeffs(int i, double dt, double* rhs)
+//
+//  Input:   i  = node index
+//           dt = time step (sec)
+//  Output:  rhs = negative of node's continuity residual (cfs);
+//           returns derivative of residual w.r.t. node head (ft2/sec)
+//  Purpose: evaluates the continuity equation of a non-outfall node at the
+//           current estimate of its depth.
+//
+{
+    int    canPond, isPonded;
+    double yCrown, yLast, dQ;
+
+    canPond = (AllowPonding && Node[i].pondedArea > 0.0);
+    isPonded = (canPond && Node[i].newDepth > Node[i].fullDepth);
+    yCrown = Node[i].crownElev - Node[i].invertElev;
+    yLast = Node[i].newDepth;
+    dQ = Node[i].inflow - Node[i].outflow;
+
+    // --- hold the head fixed at a node not being advanced or whose
+    //     depth is at a limit
+    if ( !NodeActive[i] || getHeadLimit(i) != 0 )
+    {
+        *rhs = 0.0;
+        return FIXEDHEAD;
+    }
+
+    // --- for a non-surcharged node, the change in stored volume must
+    //     balance the average net inflow over the time step
+    if ( yLast <= yCrown || Node[i].type == STORAGE || isPonded )
+    {
+        *rhs = 0.5 * (Node[i].oldNetInflow + dQ) -
+               Xnode.newSurfArea[i] * (yLast - Node[i].oldDepth) / dt;
+        return Xnode.newSurfArea[i] / dt + 0.5 * Xnode.sumdqdh[i];
+    }
+
+    // --- a surcharged node has no storage so its net inflow must be zero
+    //     (the equation is scaled by 1/2 to keep the system symmetric)
+    *rhs = 0.5 * dQ;
+    return 0.5 * Xnode.sumdqdh[i];
+}
+
+//=============================================================================
+
+int getHeadLimit(int i)
+//
+//  Input:   i = node index
+//  Output:  returns 1 if node is flooded and still filling, -1 if node
+//           is dry and still draining, or 0 otherwise
+//  Purpose: determines if a node's depth is held at one of its limits.
+//
+{
+    double dQ = Node[i].inflow - Node[i].outflow;
+    double yMax = Node[i].fullDepth;
+
+    if ( AllowPonding && Node[i].pondedArea > 0.0 ) return 0;
+    yMax += Node[i].surDepth;
+    if ( Node[i].newDepth >= yMax && dQ > 0.0 ) return 1;
+    if ( Node[i].newDepth <= 0.0 && dQ + Node[i].oldNetInflow <= 0.0 )
+        return -1;
+    return 0;
+}
+
+//=============================================================================
+
+void setNewtonNodeDepth(int i, double dh, double dt)
+//
+//  Input:   i  = node index
+//           dh = Newton-Raphson change in node head (ft)
+//           dt = time step (sec)
+//  Output:  none
+//  Purpose: applies a head change found by Newton's method to a
+//           non-outfall node, subject to the same limits used by the
+//           Picard method in setNodeDepth().
+//
+{
+    int     canPond;                   // TRUE if node can pond overflows
+    int     isPonded;                  // TRUE if node is currently ponded
+    double  dV;                        // change in node volume (ft3)
+    double  yLast;                     // previous node depth (ft)
+    double  yNew;                      // new node depth (ft)
+    double  yCrown;                    // depth to node crown (ft)
+
+    canPond = (AllowPonding && Node[i].pondedArea > 0.0);
+    isPonded = (canPond && Node[i].newDepth > Node[i].fullDepth);
+    yCrown = Node[i].crownElev - Node[i].invertElev;
+    yLast = Node[i].newDepth;
+    Node[i].overflow = 0.0;
+    dV = 0.5 * (Node[i].oldNetInflow + Node[i].inflow - Node[i].outflow) * dt;
+    yNew = yLast + dh;
+
+    // --- a node held at its flooded depth overflows its net inflow
+    //     while one held dry stays dry
+    switch ( getHeadLimit(i) )
+    {
+      case 1:
+        saveNodeDepth(i, canPond, dV, yLast + FUDGE, dt);
+        return;
+      case -1:
+        saveNodeDepth(i, canPond, dV, 0.0, dt);
+        return;
+    }
+
+    // --- node not surcharged
+    if ( yLast <= yCrown || Node[i].type == STORAGE || isPonded )
+    {
+        if ( !isPonded ) Xnode.oldSurfArea[i] = Xnode.newSurfArea[i];
+        if ( isPonded && yNew < Node[i].fullDepth )
+            yNew = Node[i].fullDepth - FUDGE;
+    }
+
+    // --- node surcharged
+    else
+    {
+        if ( yNew < yCrown ) yNew = yCrown - FUDGE;
+        if ( canPond && yNew > Node[i].fullDepth )
+            yNew = Node[i].fullDepth + FUDGE;
+    }
+    saveNodeDepth(i, canPond, dV, yNew, dt);
+}
+
+//=============================================================================
+
+double getVariableStep(double maxStep)
+//
+//  Input:   maxStep = user-supplied max. time step (sec)
+//  Output:  returns time step (sec)
+//  Purpose: finds time step that satisfies stability criterion but
+//           is no greater than the user-supplied max. time step.
+//
+{
+    int    minLink = -1;                // index of link w/ min. time step
+    int    minNode = -1;                // index of node w/ min. time step
+    double tMin;                        // allowable time step (sec)
+    double tMinLink;                    // allowable time step for links (sec)
+    double tMinNode;                    // allowable time step for nodes (sec)
+
+    // --- find stable time step for links & then nodes
+    tMin = maxStep;
+    tMinLink = getLinkStep(tMin, &minLink);
+    tMinNode = getNodeStep(tMinLink, &minNode);
+
+    // --- use smaller of the link and node time step
+    tMin = tMinLink;
+    if ( tMinNode < tMin )
+    {
+        tMin = tMinNode ;
+        minLink = -1;
+    }
+
+    // --- update count of times the minimum node or link was critical
+    stats_updateCriticalTimeCount(minNode, minLink);
+
+    // --- under multirate routing the critical time step need only be
+    //     met by the finest class of nodes and links
+    if ( MultirateClasses > 0 )                                                //(OPENSWMM 5.1.913)
+        tMin = MIN(maxStep, tMin * (1 << MultirateClasses));
+
+    // --- don't let time step go below an absolute minimum
+    if ( tMin < MinRouteStep ) tMin = MinRouteStep;                            //(5.1.008)
+    return tMin;
+}
+
+//=============================================================================
+
+double getLinkStep(double tMin, int *minLink)
+//
+//  Input:   tMin = critical time step found so far (sec)
+//  Output:  minLink = index of link with critical time step;
+//           returns critical time step (sec)
+//  Purpose: finds critical time step for conduits based on Courant criterion.
+//
+{
+    int    i;                           // link index
+    double t;                           // time step (sec)
+    double tLink = tMin;                // critical link time step (sec)
+
+    // --- examine each conduit link, with each thread finding the
+    //     critical link among those it examines
+#pragma omp parallel num_threads(NumThreads) private(t)                        //(OPENSWMM 5.1.913)
+{
+    double tThread = tMin;
+    int    iThread = -1;
+
+    #pragma omp for
+    for ( i = 0; i < Nobjects[LINK]; i++ )
+    {
+        // --- compute time step to satisfy Courant condition
+        t = getCourantStep(i);
+
+        // --- update critical link time step
+        if ( t < tThread )
+        {
+            tThread = t;
+            iThread = i;
+        }
+    }
+
+    // --- combine the results of each thread
+    #pragma omp critical
+    {
+        if ( iThread >= 0 ) updateCriticalStep(tThread, iThread, &tLink,
+                                               minLink);
+    }
+}
+    return tLink;
+}
+
+//=============================================================================
+
+double getNodeStep(double tMin, int *minNode)
+//
+//  Input:   tMin = critical time step found so far (sec)
+//  Output:  minNode = index of node with critical time step;
+//           returns critical time step (sec)
+//  Purpose: finds critical time step for nodes based on max. allowable
+//           projected change in depth.
+//
+{
+    int    i;                           // node index
+    double t1;                          // time needed to reach depth limit (sec)
+    double tNode = tMin;                // critical node time step (sec)
+
+    // --- find smallest time so that estimated change in nodal depth
+    //     does not exceed safety factor * maxdepth, with each thread
+    //     finding the critical node among those it examines
+#pragma omp parallel num_threads(NumThreads) private(t1)                       //(OPENSWMM 5.1.913)
+{
+    double tThread = tMin;
+    int    iThread = -1;
+
+    #pragma omp for
+    for ( i = 0; i < Nobjects[NODE]; i++ )
+    {
         // --- compute time to reach max. depth & compare with critical time
-        t1 = maxDepth / dYdT;
-        if ( t1 < tNode )
+        t1 = getDepthChangeStep(i);
+        if ( t1 < tThread )
         {
-            tNode = t1;
-            *minNode = i;
+            tThread = t1;
+            iThread = i;
         }
     }
+
+    // --- combine the results of each thread
+    #pragma omp critical
+    {
+        if ( iThread >= 0 ) updateCriticalStep(tThread, iThread, &tNode,
+                                               minNode);
+    }
+}
     return tNode;
 }
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+void updateCriticalStep(double t, int i, double* tMin, int* iMin)
+//
+//  Input:   t    = critical time step found for object i (sec)
+//           i    = index of node or link
+//           tMin = critical time step found so far (sec)
+//           iMin = index of object with critical time step so far
+//  Output:  updates tMin and iMin
+//  Purpose: replaces the critical time step found so far if object i's
+//           step is smaller, or is equal but i has a lower index
+//           (matching the choice made by a serial search).
+//
+{
+    if ( t < *tMin || (t == *tMin && *iMin >= 0 && i < *iMin) )
+    {
+        *tMin = t;
+        *iMin = i;
+    }
+}
+
+//=============================================================================
+
+double getCourantStep(int i)
+//
+//  Input:   i = link index
+//  Output:  returns time step (sec)
+//  Purpose: finds the time step that satisfies the Courant criterion for
+//           a conduit (or BIG if the conduit does not limit the step).
+//
+{
+    int    k;                           // conduit index
+    double q;                           // conduit flow (cfs)
+    double t;                           // time step (sec)
+
+    if ( Link[i].type != CONDUIT ) return BIG;
+
+    // --- skip conduits with negligible flow, area or Fr
+    k = Link[i].subIndex;
+    q = fabs(DwLink.newFlow[i]) / Conduit[k].barrels;
+    if ( q <= 0.05 * Link[i].qFull
+    ||   Conduit[k].a1 <= FUDGE
+    ||   DwLink.froude[i] <= 0.01
+       ) return BIG;
+
+    // --- compute time step to satisfy Courant condition
+    t = DwLink.newVolume[i] / Conduit[k].barrels / q;
+    t = t * Conduit[k].modLength / link_getLength(i);
+    t = t * DwLink.froude[i] / (1.0 + DwLink.froude[i]) * CourantFactor;
+    return t;
+}
+
+//=============================================================================
+
+double getDepthChangeStep(int i)
+//
+//  Input:   i = node index
+//  Output:  returns time step (sec)
+//  Purpose: finds the time for a node's depth to change by its maximum
+//           allowable amount (or BIG if the node does not limit the step).
+//
+{
+    double maxDepth;                    // max. depth allowed at node (ft)
+    double dYdT;                        // change in depth per unit time (ft/sec)
+
+    // --- see if node can be skipped
+    if ( DwNode.isOutfall[i] ) return BIG;
+    if ( DwNode.newDepth[i] <= FUDGE) return BIG;
+    if ( DwNode.newDepth[i] + FUDGE >= DwNode.yCrown[i] ) return BIG;
+
+    // --- define max. allowable depth change using crown elevation
+    maxDepth = DwNode.yCrown[i] * 0.25;
+    if ( maxDepth < FUDGE ) return BIG;
+    dYdT = Xnode.dYdT[i];
+    if (dYdT < FUDGE ) return BIG;
+
+    // --- compute time to reach max. depth
+    return maxDepth / dYdT;
+}
+
+//=============================================================================
+
+void setActiveObjects(int nNodes, int* nodes, int nLinks, int* links)
+//
+//  Input:   nNodes = number of nodes to advance
+//           nodes  = indexes of nodes to advance (in ascending order)
+//           nLinks = number of links to advance
+//           links  = indexes of links to advance (in ascending order)
+//  Output:  none
+//  Purpose: sets which nodes and links are advanced by the routing kernels.
+//
+{
+    int m;
+
+    for (m = 0; m < NumActiveNodes; m++) NodeActive[ActiveNodes[m]] = FALSE;
+    for (m = 0; m < NumActiveLinks; m++) LinkActive[ActiveLinks[m]] = FALSE;
+    NumActiveNodes = nNodes;
+    ActiveNodes = nodes;
+    NumActiveLinks = nLinks;
+    ActiveLinks = links;
+    for (m = 0; m < NumActiveNodes; m++) NodeActive[ActiveNodes[m]] = TRUE;
+    for (m = 0; m < NumActiveLinks; m++) LinkActive[ActiveLinks[m]] = TRUE;
+}
+
+//=============================================================================
+
+void findActiveRegion(int buffer)
+//
+//  Input:   buffer = which of the two region buffers to fill
+//  Output:  none
+//  Purpose: makes the active nodes that have not converged, their neighbors
+//           and all links attached to them the new set of active objects.
+//
+//  Note:    Nodes outside the region keep their current depths and links
+//           outside it keep their current flows. A converged neighbor that
+//           is thrown off by a change in flow joins the region on the next
+//           trial, so the region grows or shrinks one link at a time.
+//
+{
+    int  m, k, i, j, n, nSeeds;
+    int  nNodes = 0;
+    int  nLinks = 0;
+    int* nodes = RegionNodes[buffer] + RegionNodeBase;                        //(OPENSWMM 5.1.913)
+    int* links = RegionLinks[buffer] + RegionLinkBase;
+
+    // --- add unconverged active nodes
+    for (m = 0; m < NumActiveNodes; m++)
+    {
+        i = ActiveNodes[m];
+        if ( Xnode.converged[i] ) continue;
+        NodeInRegion[i] = TRUE;
+        nodes[nNodes++] = i;
+    }
+    nSeeds = nNodes;
+
+    // --- add the nodes one link away from them
+    for (m = 0; m < nSeeds; m++)
+    {
+        i = nodes[m];
+        for (k = NodeLinkStart[i]; k < NodeLinkStart[i+1]; k++)
+        {
+            j = NodeLinks[k];
+            if ( LinkClass[j] != StepClass ) continue;
+            n = ( Link[j].node1 == i ) ? Link[j].node2 : Link[j].node1;
+            if ( NodeInRegion[n] || NodeClass[n] != StepClass ) continue;
+            NodeInRegion[n] = TRUE;
+            nodes[nNodes++] = n;
+        }
+    }
+
+    // --- add every link attached to a node in the region
+    for (m = 0; m < nNodes; m++)
+    {
+        i = nodes[m];
+        for (k = NodeLinkStart[i]; k < NodeLinkStart[i+1]; k++)
+        {
+            j = NodeLinks[k];
+            if ( LinkInRegion[j] || LinkClass[j] != StepClass ) continue;
+            LinkInRegion[j] = TRUE;
+            links[nLinks++] = j;
+        }
+    }
+    for (m = 0; m < nNodes; m++) NodeInRegion[nodes[m]] = FALSE;
+
+    // --- a link between two converged nodes keeps its current flow (this
+    //     includes every link reaching a node outside the region)
+    for (m = 0; m < nLinks; m++)
+    {
+        j = links[m];
+        LinkInRegion[j] = FALSE;
+        Link[j].bypassed = ( Xnode.converged[Link[j].node1] &&
+                             Xnode.converged[Link[j].node2] );
+    }
+
+    // --- keep objects in processing order so that results do not depend
+    //     on the order in which the region was found
+    qsort(nodes, nNodes, sizeof(int), compareNodes);
+    qsort(links, nLinks, sizeof(int), compareLinks);
+    setActiveObjects(nNodes, nodes, nLinks, links);
+}
+
+//=============================================================================
+
+int compareNodes(const void* a, const void* b)
+//
+//  Input:   a, b = pointers to two node indexes
+//  Output:  returns -1, 0 or 1 as a comes before, with or after b
+//  Purpose: comparison function used to sort lists of nodes into
+//           processing order.
+//
+{
+    int i = NodeRank[*(const int *)a];
+    int j = NodeRank[*(const int *)b];
+    if ( i < j ) return -1;
+    if ( i > j ) return 1;
+    return 0;
+}
+
+//=============================================================================
+
+int compareLinks(const void* a, const void* b)
+//
+//  Input:   a, b = pointers to two link indexes
+//  Output:  returns -1, 0 or 1 as a comes before, with or after b
+//  Purpose: comparison function used to sort lists of links into
+//           processing order.
+//
+{
+    int i = LinkRank[*(const int *)a];
+    int j = LinkRank[*(const int *)b];
+    if ( i < j ) return -1;
+    if ( i > j ) return 1;
+    return 0;
+}
+
+//=============================================================================
+
+int advanceStepClasses(double tStep)
+//
+//  Input:   tStep = time step (sec)
+//  Output:  returns TRUE if all nodes converged
+//  Purpose: advances each time step class of nodes and links over a
+//           routing time step using sub-steps of length tStep / 2^class.
+//
+//  Note:    A link belongs to the finer class of its end nodes, so a link
+//           never sees a node advanced more often than itself. Within each
+//           sub-step of a coarse node, its finer links are advanced first
+//           against its current head, and the volumes they exchange with
+//           it are then applied to it over its own sub-step, so no water
+//           is gained or lost at the interface.
+//
+{
+    int s, c, n, m, i;
+    int converged = TRUE;
+    int maxSteps = 0;
+
+    n = 1 << MaxClass;
+    saveOldStates();
+    for (s = 1; s <= n; s++)
+    {
+        // --- advance each class whose sub-step ends at sub-step s of the
+        //     finest class, from finest to coarsest
+        for (c = MaxClass; c >= 0; c--)
+        {
+            if ( s % (n >> c) != 0 ) continue;
+            setActiveObjects(
+                ClassNodeStart[c+1] - ClassNodeStart[c],
+                ClassNodes + ClassNodeStart[c],
+                ClassLinkStart[c+1] - ClassLinkStart[c],
+                ClassLinks + ClassLinkStart[c]);
+            if ( NumActiveNodes == 0 && NumActiveLinks == 0 ) continue;
+
+            // --- advance class c over its sub-step
+            ClassStep = tStep / (1 << c);
+            StepClass = c;
+            if ( s > (n >> c) ) setSubStepOldStates();
+            initRoutingStep();
+            if ( !advanceStep(ClassStep) ) converged = FALSE;
+            maxSteps = MAX(maxSteps, Steps);
+
+            // --- pass link flows on to coarser end nodes and save the
+            //     volume of any flooding
+            sumFinerLinkFlows(ClassStep);
+            for (m = 0; m < NumActiveNodes; m++)
+            {
+                i = ActiveNodes[m];
+                NodeFlowSum[3*i] = 0.0;
+                NodeFlowSum[3*i+1] = 0.0;
+                NodeFlowSum[3*i+2] += Node[i].overflow * ClassStep;
+            }
+        }
+    }
+
+    // --- report average flooding over the full time step
+    for (m = ClassNodeStart[1]; m < Nobjects[NODE]; m++)
+    {
+        i = ClassNodes[m];
+        Node[i].overflow = NodeFlowSum[3*i+2] / tStep;
+        NodeFlowSum[3*i+2] = 0.0;
+    }
+    StepClass = 0;
+    setActiveObjects(Nobjects[NODE], AllNodes, Nobjects[LINK], AllLinks);
+    restoreOldStates();
+    Steps = maxSteps;
+    return converged;
+}
+
+//=============================================================================
+
+void assignStepClasses(double tStep)
+//
+//  Input:   tStep = routing time step (sec)
+//  Output:  none
+//  Purpose: assigns each node and link to the coarsest time step class
+//           whose sub-step satisfies its own stability criterion.
+//
+{
+    int i, j, c, n1, n2;
+    int changed;
+
+    // --- a node's class satisfies its own depth change criterion and the
+    //     Courant criterion of each conduit attached to it
+    for (i = 0; i < Nobjects[NODE]; i++)
+    {
+        NodeClass[i] = (char)findStepClass(tStep, getDepthChangeStep(i));
+    }
+    for (j = 0; j < Nobjects[LINK]; j++)
+    {
+        c = findStepClass(tStep, getCourantStep(j));
+        n1 = Link[j].node1;
+        n2 = Link[j].node2;
+        if ( c > NodeClass[n1] ) NodeClass[n1] = (char)c;
+        if ( c > NodeClass[n2] ) NodeClass[n2] = (char)c;
+    }
+
+    // --- a surcharged node's depth depends on the dqdh of all of its
+    //     links, so it must be advanced along with its finest neighbor
+    do
+    {
+        changed = FALSE;
+        for (j = 0; j < Nobjects[LINK]; j++)
+        {
+            n1 = Link[j].node1;
+            n2 = Link[j].node2;
+            if ( isSurcharged(n1) && NodeClass[n2] > NodeClass[n1] )
+            {
+                NodeClass[n1] = NodeClass[n2];
+                changed = TRUE;
+            }
+            if ( isSurcharged(n2) && NodeClass[n1] > NodeClass[n2] )
+            {
+                NodeClass[n2] = NodeClass[n1];
+                changed = TRUE;
+            }
+        }
+    } while ( changed );
+
+    // --- a link is advanced along with its finer end node
+    for (j = 0; j < Nobjects[LINK]; j++)
+    {
+        LinkClass[j] = MAX(NodeClass[Link[j].node1], NodeClass[Link[j].node2]);
+    }
+    listStepClasses();
+}
+
+//=============================================================================
+
+int findStepClass(double tStep, double t)
+//
+//  Input:   tStep = routing time step (sec)
+//           t = largest stable time step for a node or link (sec)
+//  Output:  returns time step class
+//  Purpose: finds the smallest class c for which tStep / 2^c does not
+//           exceed t.
+//
+{
+    int c = 0;
+    while ( c < MultirateClasses && tStep / (1 << c) > t ) c++;
+    return c;
+}
+
+//=============================================================================
+
+int isSurcharged(int i)
+//
+//  Input:   i = node index
+//  Output:  returns TRUE if node is at or near its surcharge depth
+//  Purpose: identifies a node whose depth is found from its flow imbalance
+//           rather than from its change in stored volume.
+//
+{
+    if ( DwNode.isOutfall[i] || Node[i].type == STORAGE ) return FALSE;
+    return ( DwNode.newDepth[i] + FUDGE >= DwNode.yCrown[i] );
+}
+
+//=============================================================================
+
+void listStepClasses()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: lists the nodes and links belonging to each time step class.
+//
+{
+    int i, m, c;
+    int nodeCount[MAXCLASSES+1];
+    int linkCount[MAXCLASSES+1];
+
+    for (c = 0; c <= MAXCLASSES; c++)
+    {
+        nodeCount[c] = 0;
+        linkCount[c] = 0;
+    }
+    for (i = 0; i < Nobjects[NODE]; i++) nodeCount[(int)NodeClass[i]]++;
+    for (i = 0; i < Nobjects[LINK]; i++) linkCount[(int)LinkClass[i]]++;
+
+    // --- find where each class starts and the finest class used
+    MaxClass = 0;
+    ClassNodeStart[0] = 0;
+    ClassLinkStart[0] = 0;
+    for (c = 0; c <= MAXCLASSES; c++)
+    {
+        ClassNodeStart[c+1] = ClassNodeStart[c] + nodeCount[c];
+        ClassLinkStart[c+1] = ClassLinkStart[c] + linkCount[c];
+        if ( nodeCount[c] > 0 ) MaxClass = c;
+        nodeCount[c] = ClassNodeStart[c];
+        linkCount[c] = ClassLinkStart[c];
+    }
+
+    // --- list each class's nodes & links in processing order
+    for (m = 0; m < Nobjects[NODE]; m++)
+    {
+        i = AllNodes[m];
+        ClassNodes[nodeCount[(int)NodeClass[i]]++] = i;
+    }
+    for (m = 0; m < Nobjects[LINK]; m++)
+    {
+        i = AllLinks[m];
+        ClassLinks[linkCount[(int)LinkClass[i]]++] = i;
+    }
+}
+
+//=============================================================================
+
+void saveOldStates()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: saves the old hydraulic states of sub-stepped nodes and links
+//           at the start of a routing time step.
+//
+{
+    int m, i, k;
+
+    for (m = ClassNodeStart[1]; m < Nobjects[NODE]; m++)
+    {
+        i = ClassNodes[m];
+        NodeOldState[3*i]   = Node[i].oldDepth;
+        NodeOldState[3*i+1] = Node[i].oldVolume;
+        NodeOldState[3*i+2] = Node[i].oldNetInflow;
+    }
+    for (m = ClassLinkStart[1]; m < Nobjects[LINK]; m++)
+    {
+        i = ClassLinks[m];
+        LinkOldState[5*i]   = Link[i].oldFlow;
+        LinkOldState[5*i+1] = Link[i].oldDepth;
+        LinkOldState[5*i+2] = Link[i].oldVolume;
+        if ( Link[i].type == CONDUIT )
+        {
+            k = Link[i].subIndex;
+            LinkOldState[5*i+3] = Conduit[k].q1Old;
+            LinkOldState[5*i+4] = Conduit[k].q2Old;
+        }
+    }
+}
+
+//=============================================================================
+
+void setSubStepOldStates()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: replaces the old hydraulic states of the active nodes and links
+//           with their current ones at the start of a sub-step.
+//
+{
+    int m, i;
+
+    for (m = 0; m < NumActiveNodes; m++)
+    {
+        i = ActiveNodes[m];
+        Node[i].oldDepth = Node[i].newDepth;
+        Node[i].oldVolume = Node[i].newVolume;
+        Node[i].oldNetInflow = Node[i].inflow - Node[i].outflow;
+    }
+    for (m = 0; m < NumActiveLinks; m++) link_setOldHydState(ActiveLinks[m]);
+}
+
+//=============================================================================
+
+void restoreOldStates()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: restores the old hydraulic states of sub-stepped nodes and
+//           links to their values at the start of the routing time step.
+//
+{
+    int m, i, k;
+
+    for (m = ClassNodeStart[1]; m < Nobjects[NODE]; m++)
+    {
+        i = ClassNodes[m];
+        Node[i].oldDepth     = NodeOldState[3*i];
+        Node[i].oldVolume    = NodeOldState[3*i+1];
+        Node[i].oldNetInflow = NodeOldState[3*i+2];
+    }
+    for (m = ClassLinkStart[1]; m < Nobjects[LINK]; m++)
+    {
+        i = ClassLinks[m];
+        Link[i].oldFlow   = LinkOldState[5*i];
+        Link[i].oldDepth  = LinkOldState[5*i+1];
+        Link[i].oldVolume = LinkOldState[5*i+2];
+        if ( Link[i].type == CONDUIT )
+        {
+            k = Link[i].subIndex;
+            Conduit[k].q1Old = LinkOldState[5*i+3];
+            Conduit[k].q2Old = LinkOldState[5*i+4];
+        }
+    }
+}
+
+//=============================================================================
+
+void addFinerLinkFlows(int i)
+//
+//  Input:   i = node index
+//  Output:  none
+//  Purpose: adds to a node's inflow & outflow the average flows it received
+//           from links of finer time step classes over its current sub-step.
+//
+{
+    Node[i].inflow  += NodeFlowSum[3*i] / ClassStep;
+    Node[i].outflow += NodeFlowSum[3*i+1] / ClassStep;
+}
+
+//=============================================================================
+
+void sumFinerLinkFlows(double dt)
+//
+//  Input:   dt = sub-step just completed by the active links (sec)
+//  Output:  none
+//  Purpose: adds the volumes that the active links exchanged with end nodes
+//           of coarser time step classes to those nodes' running totals.
+//
+{
+    int    m, j, n1, n2;
+    double q;
+    double uniformLossRate;
+
+    for (m = 0; m < NumActiveLinks; m++)
+    {
+        j = ActiveLinks[m];
+        n1 = Link[j].node1;
+        n2 = Link[j].node2;
+        if ( NodeActive[n1] && NodeActive[n2] ) continue;
+        q = DwLink.newFlow[j];
+        uniformLossRate = 0.0;
+        if ( Link[j].type == CONDUIT )
+        {
+            uniformLossRate = Conduit[Link[j].subIndex].evapLossRate +
+                              Conduit[Link[j].subIndex].seepLossRate;
+        }
+        if ( !NodeActive[n1] )
+        {
+            if ( q >= 0.0 ) NodeFlowSum[3*n1+1] += (q + uniformLossRate) * dt;
+            else            NodeFlowSum[3*n1]   -= q * dt;
+        }
+        if ( !NodeActive[n2] )
+        {
+            if ( q >= 0.0 ) NodeFlowSum[3*n2]   += q * dt;
+            else            NodeFlowSum[3*n2+1] -= (q - uniformLossRate) * dt;
+        }
+    }
+}
@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------------------
+//   dynwave.h
+//
+//   Project: OpenSWMM
+//   Version: 5.1
+//   Date:    10/16/26   (Build 5.1.913)
+//
+//   Routing state shared by the dynamic wave routing modules dynwave.c
+//   and dwflow.c.
+//
+//   The few node and link variables that the dynamic wave kernels read
+//   and write on every iteration are kept in packed arrays (one array per
+//   variable) rather than being picked out of the much larger TNode and
+//   TLink structures. The arrays are loaded from Node[] and Link[] at the
+//   start of each routing step and every new value a kernel computes is
+//   written to both places, so the two always agree between kernels.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef DYNWAVE_H
+#define DYNWAVE_H
+
+// Number of conduits whose flows are updated as one block
+#define DW_BATCH  64
+
+//-----------------------------------------------------------------------------
+//  Data Structures
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    double* newDepth;        // current water depth (ft)
+    double* invertElev;      // invert elevation (ft)
+    double* yCrown;          // depth to highest connecting crown (ft)
+    char*   isOutfall;       // TRUE if node is an outfall
+} TDwNodeState;
+
+typedef struct
+{
+    double* newFlow;         // current flow rate (cfs)
+    double* newDepth;        // current flow depth (ft)
+    double* newVolume;       // current volume (ft3)
+    double* froude;          // Froude number
+    double* dqdh;            // change in flow w.r.t. head (ft2/sec)
+} TDwLinkState;
+
+//-----------------------------------------------------------------------------
+//  Shared Variables (declared in dynwave.c)
+//-----------------------------------------------------------------------------
+extern TDwNodeState DwNode;
+extern TDwLinkState DwLink;
+
+#endif
@@ -337,6 +337,14 @@ enum  SubAreaType {
       H_W,                             // Hazen-Williams eqn.
       D_W};                            // Darcy-Weisbach eqn.
 
+ enum SolverMethodType {
+      PICARD,                          // under-relaxed successive approx.
+      NEWTON};                         // implicit Newton-Raphson on heads
+
+ enum AccelerationType {                                                       //(OPENSWMM 5.1.913)
+      NO_ACCEL,                        // no acceleration of iterations
+      ANDERSON};                       // Anderson mixing of node depths
+
  enum OffsetType {
       DEPTH_OFFSET,                    // offset measured as depth
       ELEV_OFFSET};                    // offset measured as elevation
@@ -462,7 +470,10 @@ enum  CompatibilityType {
 	 IGNORE_QUALITY, MAX_TRIALS, HEAD_TOL,
 	 SYS_FLOW_TOL, LAT_FLOW_TOL, IGNORE_RDII,                       //(5.1.004)
 	 MIN_ROUTE_STEP, NUM_THREADS,                                   //(5.1.008)
-	 WATER_AGE	   //(OPENSWMM 5.1.912)
+	 WATER_AGE,	   //(OPENSWMM 5.1.912)
+	 SOLVER_METHOD, MULTIRATE_CLASSES, SOLVER_ACCEL,                //(OPENSWMM 5.1.913)
+	 SOLVER_PREDICTOR, GEOMETRY_TOL, CHECK_GEOM_TABLES, STORAGE_TOL,
+	 FRICTION_TABLE
  };			
 
 enum  NoYesType {
@@ -16,6 +16,11 @@
 //   Build 5.1.010:
 //   - Text of Error 318 for rainfall data files modified.
 //
+//   OpenSWMM 5.1.913:
+//   - Text copied to ErrString is truncated to fit.
+//   - ErrString made thread private so input lines can be parsed in parallel.
+//   - Error messages added for compiled input files.
+//
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -160,6 +165,10 @@
 #define ERR361 "\n  ERROR 361: could not open external file used for Time Series %s."
 #define ERR363 "\n  ERROR 363: invalid data in external file used for Time Series %s."
 
+#define ERR365 "\n  ERROR 365: cannot write compiled input file %s."           //(OPENSWMM 5.1.913)
+#define ERR367 \
+"\n  ERROR 367: compiled input file %s is not valid for this version of SWMM." //(OPENSWMM 5.1.913)
+
 #define ERR401 "\n  ERROR 401: general system error."
 #define ERR402 \
 "\n  ERROR 402: cannot open new project while current project still open."
@@ -186,7 +195,8 @@ char* ErrorMsgs[] =
       ERR313, ERR315, ERR317, ERR318, ERR319, ERR320, ERR321, ERR323, ERR325,
       ERR327, ERR329, ERR330, ERR331, ERR333, ERR335, ERR336, ERR337, ERR338,
       ERR339, ERR341, ERR343, ERR345, ERR351, ERR353, ERR355, ERR357, ERR361,
-      ERR363, ERR401, ERR402, ERR403, ERR405, ERR901};// (OPENSWMM 5.1.911)
+      ERR363, ERR365, ERR367,                                                  //(OPENSWMM 5.1.913)
+      ERR401, ERR402, ERR403, ERR405, ERR901};// (OPENSWMM 5.1.911)
 
 int ErrorCodes[] =
     { 0,      101,    103,    105,    107,    108,    109,    110,    111,
@@ -200,9 +210,11 @@ int ErrorCodes[] =
       313,    315,    317,    318,    319,    320,    321,    323,    325,
       327,    329,    330,    331,    333,    335,    336,    337,    338,
       339,    341,    343,    345,    351,    353,    355,    357,    361,
-      363, 401, 402, 403, 405, 901};// (OPENSWMM 5.1.911)
+      363,    365,    367,                                                     //(OPENSWMM 5.1.913)
+      401, 402, 403, 405, 901};// (OPENSWMM 5.1.911)
 
 char  ErrString[256];
+#pragma omp threadprivate(ErrString)                                           //(OPENSWMM 5.1.913)
 
 char* error_getMsg(int i)
 {
@@ -218,6 +230,8 @@ int  error_getCode(int i)
 
 int  error_setInpError(int errcode, char* s)
 {
-    strcpy(ErrString, s);
+    // --- input lines have no length limit, so truncate long tokens           //(OPENSWMM 5.1.913)
+    strncpy(ErrString, s, sizeof(ErrString) - 1);                              //(OPENSWMM 5.1.913)
+    ErrString[sizeof(ErrString) - 1] = '\0';                                   //(OPENSWMM 5.1.913)
     return errcode;
 }
@@ -154,12 +154,16 @@ enum  ErrorType {
       ERR_TABLE_FILE_OPEN,      //361  98
       ERR_TABLE_FILE_READ,      //363  99
 
+  //... Compiled Input File Errors                                             //(OPENSWMM 5.1.913)
+      ERR_COMPILED_WRITE,       //365  100                                     //(OPENSWMM 5.1.913)
+      ERR_COMPILED_READ,        //367  101                                     //(OPENSWMM 5.1.913)
+
   //... Runtime Errors
-      ERR_SYSTEM,               //401  100
-      ERR_NOT_CLOSED,           //402  101
-      ERR_NOT_OPEN,             //403  102
-      ERR_FILE_SIZE,            //405  103
-	  ERR_SEASONAL,				//901  104 for non-MONTHLY pattern	//(OPENSWMM 5.1.911)
+      ERR_SYSTEM,               //401  102
+      ERR_NOT_CLOSED,           //402  103
+      ERR_NOT_OPEN,             //403  104
+      ERR_FILE_SIZE,            //405  105
+	  ERR_SEASONAL,				//901  106 for non-MONTHLY pattern	//(OPENSWMM 5.1.911)
 
       MAXERRMSG};
       
@@ -7,6 +7,11 @@
 //   Author:   L. Rossman
 //
 //   Special Non-Manning Force Main functions
+//
+//   OpenSWMM 5.1.913:
+//   - Darcy-Weisbach friction factors can be interpolated from a table
+//     over log relative roughness and log Reynolds number (see the
+//     FRICTION_FACTOR_TABLE option).
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -19,18 +24,37 @@
 static const double VISCOS = 1.1E-5;   // Kinematic viscosity of water
                                        // @ 20 deg C (sq ft/sec)
 
+// Friction factor table grid (in log10 units)                                 //(OPENSWMM 5.1.913)
+#define  FRIC_LOGE_MIN   -7.0          // min. log relative roughness
+#define  FRIC_LOGRE_MIN  3.5           // min. log Reynolds number
+#define  FRIC_STEP       0.05          // grid spacing
+#define  N_FRIC_E        121           // # relative roughness grid points
+#define  N_FRIC_RE       131           // # Reynolds number grid points
+
+//-----------------------------------------------------------------------------
+//  Shared variables
+//-----------------------------------------------------------------------------
+static double FricFactors[N_FRIC_E][N_FRIC_RE]; // friction factor table       //(OPENSWMM 5.1.913)
+static int    FricTableBuilt;          // TRUE once the table is built
+static double FricTableError;          // max. relative error of table
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
 // forcemain_getEquivN
 // forcemain_getRoughFactor
 // forcemain_getFricSlope
+// forcemain_createFricTable
+// forcemain_getFricTableError
 
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
 static double forcemain_getFricFactor(double e, double hrad, double re);
 static double forcemain_getReynolds(double v, double hrad);
+static double forcemain_lookupFricFactor(double e, double hrad, double re);    //(OPENSWMM 5.1.913)
+static double forcemain_getTableFactor(double logE, double logRe);
+static double forcemain_getTurbFricFactor(double logE, double logRe);
 
 //=============================================================================
 
@@ -99,15 +123,18 @@ double forcemain_getFricSlope(int j, double v, double hrad)
 //
 {
     double re, f;
-    TXsect xsect = Link[j].xsect;
+    TXsect* xsect = &Link[j].xsect;                                            //(OPENSWMM 5.1.913)
     switch ( ForceMainEqn )
     {
       case H_W:
-        return xsect.sBot * pow(v, 0.852) / pow(hrad, 1.1667);
+        return xsect->sBot * pow(v, 0.852) / pow(hrad, 1.1667);
       case D_W:
         re = forcemain_getReynolds(v, hrad);
-        f = forcemain_getFricFactor(xsect.rBot, hrad, re);
-        return f * xsect.sBot * v / hrad;
+        if ( FricFactorTable )                                                 //(OPENSWMM 5.1.913)
+            f = forcemain_lookupFricFactor(xsect->rBot, hrad, re);
+        else
+            f = forcemain_getFricFactor(xsect->rBot, hrad, re);
+        return f * xsect->sBot * v / hrad;
     }
     return 0.0;
 }
@@ -155,3 +182,139 @@ double forcemain_getFricFactor(double e, double hrad, double re)
     }
     return f;
 }
+
+//=============================================================================
+
+////  New functions added to release 5.1.913.  ////                            //(OPENSWMM 5.1.913)
+
+void forcemain_createFricTable()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: tabulates the Darcy-Weisbach friction factor for turbulent flow
+//           over a grid of log relative roughness and log Reynolds number
+//           and finds the largest relative error of bilinear interpolation
+//           from it.
+//
+//  NOTE: the table does not depend on any project data, so it is only
+//        built once.
+//
+{
+    int    i, j, m;
+    double logE, logRe, f, err;
+    static const double s[3] = {0.5, 0.5, 0.0};  // positions of points
+    static const double t[3] = {0.5, 0.0, 0.5};  // checked in a grid cell
+
+    if ( FricTableBuilt ) return;
+
+    // --- evaluate friction factor at each grid point
+    for (i = 0; i < N_FRIC_E; i++)
+    {
+        for (j = 0; j < N_FRIC_RE; j++)
+        {
+            logE = FRIC_LOGE_MIN + i * FRIC_STEP;
+            logRe = FRIC_LOGRE_MIN + j * FRIC_STEP;
+            FricFactors[i][j] = forcemain_getTurbFricFactor(logE, logRe);
+        }
+    }
+
+    // --- compare interpolated and exact factors at the center and
+    //     edge midpoints of each grid cell
+    FricTableError = 0.0;
+    for (i = 0; i < N_FRIC_E - 1; i++)
+    {
+        for (j = 0; j < N_FRIC_RE - 1; j++)
+        {
+            for (m = 0; m < 3; m++)
+            {
+                logE = FRIC_LOGE_MIN + (i + s[m]) * FRIC_STEP;
+                logRe = FRIC_LOGRE_MIN + (j + t[m]) * FRIC_STEP;
+                f = forcemain_getTurbFricFactor(logE, logRe);
+                err = fabs(forcemain_getTableFactor(logE, logRe) - f) / f;
+                FricTableError = MAX(FricTableError, err);
+            }
+        }
+    }
+    FricTableBuilt = TRUE;
+}
+
+//=============================================================================
+
+double forcemain_getFricTableError()
+//
+//  Input:   none
+//  Output:  returns the largest relative error found in the friction factor
+//           table (or 0 if the table has not been built)
+//  Purpose: reports the accuracy of the friction factor table.
+//
+{
+    return FricTableError;
+}
+
+//=============================================================================
+
+double forcemain_lookupFricFactor(double e, double hrad, double re)
+//
+//  Input:   e = roughness height (ft)
+//           hrad = hydraulic radius (ft)
+//           re = Reynolds number
+//  Output:  returns a Darcy-Weisbach friction factor
+//  Purpose: interpolates the friction factor table, using the exact
+//           formula for laminar and transitional flow or for values that
+//           lie outside of the table.
+//
+{
+    double logE, logRe;
+
+    if ( !FricTableBuilt || re < 4000.0 || re >= 1.0e10 || e <= 0.0 )
+        return forcemain_getFricFactor(e, hrad, re);
+    logE = log10(e / (4.0 * hrad));
+    logRe = log10(re);
+    if ( logE < FRIC_LOGE_MIN ||
+         logE >= FRIC_LOGE_MIN + (N_FRIC_E - 1) * FRIC_STEP )
+        return forcemain_getFricFactor(e, hrad, re);
+    return forcemain_getTableFactor(logE, logRe);
+}
+
+//=============================================================================
+
+double forcemain_getTableFactor(double logE, double logRe)
+//
+//  Input:   logE = log10 of relative roughness
+//           logRe = log10 of Reynolds number
+//  Output:  returns a Darcy-Weisbach friction factor
+//  Purpose: bilinearly interpolates the friction factor table at a point
+//           that lies within it.
+//
+{
+    int    i, j;
+    double s, t;
+
+    s = (logE - FRIC_LOGE_MIN) / FRIC_STEP;
+    t = (logRe - FRIC_LOGRE_MIN) / FRIC_STEP;
+    i = MIN((int)s, N_FRIC_E - 2);
+    j = MIN((int)t, N_FRIC_RE - 2);
+    s -= i;
+    t -= j;
+    return (1.0 - s) * ((1.0 - t) * FricFactors[i][j] + t * FricFactors[i][j+1])
+           + s * ((1.0 - t) * FricFactors[i+1][j] + t * FricFactors[i+1][j+1]);
+}
+
+//=============================================================================
+
+double forcemain_getTurbFricFactor(double logE, double logRe)
+//
+//  Input:   logE = log10 of relative roughness
+//           logRe = log10 of Reynolds number
+//  Output:  returns a Darcy-Weisbach friction factor
+//  Purpose: evaluates the Swamee and Jain friction factor for turbulent
+//           flow used by forcemain_getFricFactor at a table grid point.
+//
+//  NOTE: the Reynolds number term is always kept so that the table stays
+//        continuous up to its upper limit of Re = 1.0e10.
+//
+{
+    double f = pow(10.0, logE) / 3.7 + 5.74 / pow(10.0, 0.9 * logRe);
+    f = log10(f);
+    return 0.25 / f / f;
+}
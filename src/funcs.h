@@ -32,7 +32,7 @@ void     project_open(char *f1, char *f2, char *f3);
 void     project_close(void);
 
 void     project_readInput(void);
-int      project_readOption(char* s1, char* s2);
+int      project_readOption(char* s1, char* s2, char* s3);                  //(OPENSWMM 5.1.913)
 void     project_validate(void);
 int      project_init(void);
 
@@ -48,6 +48,7 @@ void     project_freeMatrix(double** m);
 //-----------------------------------------------------------------------------
 int     input_countObjects(void);
 int     input_readData(void);
+void    input_setCompiledFile(char* fname);                                    //(OPENSWMM 5.1.913)
 
 //-----------------------------------------------------------------------------
 //   Report Writer Methods
@@ -211,6 +212,7 @@ double  flowrout_getRoutingStep(int routingModel, double fixedStep);
 int     flowrout_execute(int links[], int routingModel, double tStep);
 
 void    toposort_sortLinks(int links[]);
+int     toposort_sortForLocality(int nodes[], int links[], int component[]);   //(OPENSWMM 5.1.913)
 int     kinwave_execute(int link, double* qin, double* qout, double tStep);
 
 void    dynwave_validate(void);                                                //(5.1.008)
@@ -219,6 +221,8 @@ void    dynwave_close(void);
 double  dynwave_getRoutingStep(double fixedStep);
 int     dynwave_execute(double tStep);
 void    dwflow_findConduitFlow(int j, int steps, double omega, double dt);
+void    dwflow_findConduitFlows(int links[], int n, int steps, double omega,   //(OPENSWMM 5.1.913)
+        double dt);
 
 void    qualrout_init(void);
 void    qualrout_execute(double tStep);
@@ -417,17 +421,26 @@ int     xsect_isOpen(int type);
 int     xsect_setParams(TXsect *xsect, int type, double p[], double ucf);
 void    xsect_setIrregXsectParams(TXsect *xsect);
 void    xsect_setCustomXsectParams(TXsect *xsect);
+void    xsect_createInvTables(TXsect *xsect);                                  //(OPENSWMM 5.1.913)
+double* xsect_shareTables(double tables[], int n);
+void    xsect_deleteSharedTables(void);
+void    xsect_getTableErrors(double* yCritErr, double* yNormErr);
 double  xsect_getAmax(TXsect* xsect);
 
 double  xsect_getSofA(TXsect* xsect, double area);
 double  xsect_getYofA(TXsect* xsect, double area);
 double  xsect_getRofA(TXsect* xsect, double area);
 double  xsect_getAofS(TXsect* xsect, double sFactor);
+double  xsect_getYofS(TXsect* xsect, double sFactor);                          //(OPENSWMM 5.1.913)
 double  xsect_getdSdA(TXsect* xsect, double area);
 double  xsect_getAofY(TXsect* xsect, double y);
 double  xsect_getRofY(TXsect* xsect, double y);
 double  xsect_getWofY(TXsect* xsect, double y);
 double  xsect_getYcrit(TXsect* xsect, double q);
+void    xsect_getAofYs(TXsect* xsect[], double y[], double a[], int n);        //(OPENSWMM 5.1.913)
+void    xsect_getWofYs(TXsect* xsect[], double y[], double w[], int n);
+void    xsect_getRofYs(TXsect* xsect[], double y[], double r[], int n);
+void    xsect_getSofAs(TXsect* xsect[], double a[], double s[], int n);
 
 //-----------------------------------------------------------------------------
 //   Culvert/Roadway Methods                                                   //(5.1.010)
@@ -442,6 +455,8 @@ double  roadway_getInflow(int link, double dir, double hcrest, double h1,
 double  forcemain_getEquivN(int j, int k);
 double  forcemain_getRoughFactor(int j, double lengthFactor);
 double  forcemain_getFricSlope(int j, double v, double hrad);
+void    forcemain_createFricTable(void);                                       //(OPENSWMM 5.1.913)
+double  forcemain_getFricTableError(void);
 
 //-----------------------------------------------------------------------------
 //   Cross-Section Transect Methods
@@ -478,6 +493,7 @@ void    table_deleteEntries(TTable* table);
 
 void    table_init(TTable* table);
 int     table_validate(TTable* table);
+int     table_convertFile(char* txtFile, char* binFile);                       //(OPENSWMM 5.1.913)
 //      table_interpolate now defined in table.c                               //(5.1.008)
 
 double  table_lookup(TTable* table, double x);
@@ -492,6 +508,8 @@ double  table_getInverseArea(TTable* table, double a);
 
 void    table_tseriesInit(TTable *table);
 double  table_tseriesLookup(TTable* table, double t, char extend);
+double  table_tseriesLookupAt(TTable* table, int* cursor, double t,            //(OPENSWMM 5.1.913)
+        char extend);
 
 //-----------------------------------------------------------------------------
 //   Utility Methods
@@ -83,6 +83,9 @@ EXTERN int
                   IgnoreRouting,            // Ignore flow routing
                   IgnoreQuality,            // Ignore water quality
 				  ModelWaterAge,			// Flag for model water age        //(OPENSWMM 5.1.912)
+                  SolverPredictor,          // Predict start of DW iterations  //(OPENSWMM 5.1.913)
+                  CheckGeomTables,          // Check geometry tables           //(OPENSWMM 5.1.913)
+                  FricFactorTable,          // Use friction factor table       //(OPENSWMM 5.1.913)
                   ErrorCode,                // Error code number
                   Warnings,                 // Number of warning messages      //(5.1.011)
                   WetStep,                  // Runoff wet time step (sec)
@@ -92,6 +95,10 @@ EXTERN int
                   SweepEnd,                 // Day of year when sweeping ends
                   MaxTrials,                // Max. trials for DW routing
                   NumThreads,               // Number of parallel threads used //(5.1.008)
+                  SolverMethod,             // DW routing solution method      //(OPENSWMM 5.1.913)
+                  MultirateClasses,         // Number of DW time step classes  //(OPENSWMM 5.1.913)
+                  SolverAccel,              // DW iteration acceleration       //(OPENSWMM 5.1.913)
+                  AccelTerms,               // Number of Anderson terms        //(OPENSWMM 5.1.913)
                   NumEvents;                // Number of detailed events       //(5.1.011)
                 //InSteadyState;            // System flows remain constant    //(5.1.012)
 
@@ -109,6 +116,8 @@ EXTERN double
                   QualError,                // Quality routing error
                   HeadTol,                  // DW routing head tolerance (ft)
                   SysFlowTol,               // Tolerance for steady system flow
+                  GeometryTol,              // Tolerance of geometry tables    //(OPENSWMM 5.1.913)
+                  StorageTol,               // Tolerance of storage tables     //(OPENSWMM 5.1.913)
                   LatFlowTol;               // Tolerance for steady nodal inflow       
 
 EXTERN DateTime
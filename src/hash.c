@@ -7,6 +7,13 @@
 //   Written by L. Rossman
 //   Last Updated on 6/19/03
 //
+//   OpenSWMM 5.1.913:
+//   - Fixed size table of chained entries replaced with an open addressing
+//     table (linear probing) that doubles in size when half full.
+//   - Fletcher checksum replaced with the FNV-1a hash.
+//   - No memory is allocated for each key. Key strings are not copied, so
+//     callers keep them in a memory pool (see project_addObject).
+//
 //   The hash table data structure (HTable) is defined in "hash.h".
 //   Interface Functions:
 //      HTcreate() - creates a hash table
@@ -15,11 +22,15 @@
 //      HTfree()   - frees a hash table
 //-----------------------------------------------------------------------------
 
+#include <stdlib.h>                                                            //(OPENSWMM 5.1.913)
 #include <malloc.h>
 #include <string.h>
 #include "hash.h"
 #define UCHAR(x) (((x) >= 'a' && (x) <= 'z') ? ((x)&~32) : (x))
 
+static int findEntry(HTtable *ht, char *key, unsigned int h);                  //(OPENSWMM 5.1.913)
+static int grow(HTtable *ht);                                                  //(OPENSWMM 5.1.913)
+
 /* Case-insensitive comparison of strings s1 and s2 */
 int  samestr(char *s1, char *s2)
 {
@@ -29,89 +40,105 @@ int  samestr(char *s1, char *s2)
    return(0);
 }                                       /*  End of samestr  */
 
-/* Use Fletcher's checksum to compute 2-byte hash of string */
+////  Following code was re-written for release 5.1.913.  ////                 //(OPENSWMM 5.1.913)
+
+/* Use case-insensitive FNV-1a to compute 4-byte hash of string */
 unsigned int hash(char *str)
 {
-    unsigned int sum1= 0, check1;
-    unsigned long sum2= 0L;
-	while(  '\0' != *str  )
+    unsigned int h = 2166136261u;
+    while ( '\0' != *str )
     {
-        sum1 += UCHAR(*str);
+        h ^= (unsigned char)UCHAR(*str);
+        h *= 16777619u;
         str++;
-        if (  255 <= sum1  ) sum1 -= 255;
-        sum2 += sum1;
     }
-    check1= sum2;
-    check1 %= 255;
-    check1= 255 - (sum1+check1) % 255;
-    sum1= 255 - (sum1+check1) % 255;
-    return( ( ( check1 << 8 )  |  sum1  ) % HTMAXSIZE);
+    return(h);
 }
 
-HTtable *HTcreate()
+/* Index of entry holding key or of the empty entry where it belongs */
+static int findEntry(HTtable *ht, char *key, unsigned int h)
+{
+        unsigned int mask = ht->size - 1;
+        unsigned int i = h & mask;
+        struct HTentry *entry;
+        for (;;)
+        {
+            entry = &ht->entries[i];
+            if ( entry->key == NULL ) return(i);
+            if ( entry->hash == h && samestr(entry->key, key) ) return(i);
+            i = (i + 1) & mask;
+        }
+}
+
+/* Double the number of entries in a table */
+static int grow(HTtable *ht)
 {
         int i;
-        HTtable *ht = (HTtable *) calloc(HTMAXSIZE, sizeof(HTtable));
-        if (ht != NULL) for (i=0; i<HTMAXSIZE; i++) ht[i] = NULL;
+        unsigned int j, mask;
+        int newSize = 2 * ht->size;
+        struct HTentry *entries;
+        entries = (struct HTentry *) calloc(newSize, sizeof(struct HTentry));
+        if (entries == NULL) return(0);
+        mask = newSize - 1;
+        for (i=0; i<ht->size; i++)
+        {
+            if ( ht->entries[i].key == NULL ) continue;
+            j = ht->entries[i].hash & mask;
+            while ( entries[j].key != NULL ) j = (j + 1) & mask;
+            entries[j] = ht->entries[i];
+        }
+        free(ht->entries);
+        ht->entries = entries;
+        ht->size = newSize;
+        return(1);
+}
+
+HTtable *HTcreate()
+{
+        HTtable *ht = (HTtable *) malloc(sizeof(HTtable));
+        if (ht == NULL) return(NULL);
+        ht->entries = (struct HTentry *) calloc(HTMINSIZE,
+                                                sizeof(struct HTentry));
+        if (ht->entries == NULL)
+        {
+            free(ht);
+            return(NULL);
+        }
+        ht->size = HTMINSIZE;
+        ht->count = 0;
         return(ht);
 }
 
+/* A key that is already in the table has its value replaced */
 int     HTinsert(HTtable *ht, char *key, int data)
 {
-        unsigned int i = hash(key);
+        unsigned int h = hash(key);
         struct HTentry *entry;
-        if ( i >= HTMAXSIZE ) return(0);
-        entry = (struct HTentry *) malloc(sizeof(struct HTentry));
-        if (entry == NULL) return(0);
+        if ( 2 * (ht->count + 1) > ht->size && !grow(ht) ) return(0);
+        entry = &ht->entries[findEntry(ht, key, h)];
+        if ( entry->key == NULL ) ht->count++;
         entry->key = key;
         entry->data = data;
-        entry->next = ht[i];
-        ht[i] = entry;
+        entry->hash = h;
         return(1);
 }
 
 int     HTfind(HTtable *ht, char *key)
 {
-        unsigned int i = hash(key);
-        struct HTentry *entry;
-        if ( i >= HTMAXSIZE ) return(NOTFOUND);
-        entry = ht[i];
-        while (entry != NULL)
-        {
-            if ( samestr(entry->key,key) ) return(entry->data);
-            entry = entry->next;
-        }
-        return(NOTFOUND);
+        struct HTentry *entry = &ht->entries[findEntry(ht, key, hash(key))];
+        if ( entry->key == NULL ) return(NOTFOUND);
+        return(entry->data);
 }
 
 char    *HTfindKey(HTtable *ht, char *key)
 {
-        unsigned int i = hash(key);
-        struct HTentry *entry;
-        if ( i >= HTMAXSIZE ) return(NULL);
-        entry = ht[i];
-        while (entry != NULL)
-        {
-            if ( samestr(entry->key,key) ) return(entry->key);
-            entry = entry->next;
-        }
-        return(NULL);
+        struct HTentry *entry = &ht->entries[findEntry(ht, key, hash(key))];
+        return(entry->key);
 }
 
 void    HTfree(HTtable *ht)
 {
-        struct HTentry *entry,
-                       *nextentry;
-        int i;
-        for (i=0; i<HTMAXSIZE; i++)
-        {
-            entry = ht[i];
-            while (entry != NULL)
-            {
-                nextentry = entry->next;
-                free(entry);
-                entry = nextentry;
-            }
-        }
+        free(ht->entries);
         free(ht);
 }
+////
@@ -4,17 +4,24 @@
 //   Header file for Hash Table module hash.c.
 //-----------------------------------------------------------------------------
 
-#define HTMAXSIZE 1999
+#define HTMINSIZE 64                                                           //(OPENSWMM 5.1.913)
 #define NOTFOUND  -1
 
+////  Following data structures were re-defined for release 5.1.913.  ////     //(OPENSWMM 5.1.913)
 struct HTentry
 {
-    char   *key;
-    int    data;
-    struct HTentry *next;
+    char         *key;                 // key string (NULL if entry is empty)
+    int          data;                 // value stored with key
+    unsigned int hash;                 // full hash value of key
 };
 
-typedef struct HTentry *HTtable;
+typedef struct
+{
+    struct HTentry *entries;           // array of table entries
+    int            size;               // number of entries (a power of 2)
+    int            count;              // number of entries in use
+}  HTtable;
+////
 
 HTtable *HTcreate(void);
 int     HTinsert(HTtable *, char *, int);
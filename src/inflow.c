@@ -142,6 +142,7 @@ int inflow_readExtInflow(char* tok[], int ntoks)
     inflow->param    = param;
     inflow->type     = type;
     inflow->tSeries  = tseries;
+    inflow->tsCursor = 0;
     inflow->cFactor  = cf;
     inflow->sFactor  = sf;
     inflow->baseline = baseline;
@@ -195,7 +196,8 @@ double inflow_getExtInflow(TExtInflow* inflow, DateTime aDate)
         hour  = datetime_hourOfDay(aDate);
         blv  *= inflow_getPatternFactor(p, month, day, hour);
     }
-    if ( k >= 0 ) tsv = table_tseriesLookup(&Tseries[k], aDate, FALSE) * sf;
+    if ( k >= 0 ) tsv = table_tseriesLookupAt(&Tseries[k], &inflow->tsCursor,  //(OPENSWMM 5.1.913)
+                                              aDate, FALSE) * sf;
     return cf * (tsv + blv);
 }
 
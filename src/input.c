@@ -16,21 +16,99 @@
 //   Build 5.1.011:
 //   - Support added for reading hydraulic event dates.
 //
+//   OpenSWMM 5.1.913:
+//   - Input file is read and tokenized only once. Lines are saved in a
+//     memory pool while objects are counted and then parsed from there.
+//   - Input file is memory-mapped when possible and its lines are split
+//     into token slices in place, with no limit on line length.
+//   - Fast path added to getDouble() and getFloat() for plain decimals.
+//   - Long sections of independent lines are parsed in parallel and lines
+//     of map sections are no longer saved.
+//   - Input lines of a validated project can be saved to a compiled input
+//     file whose lines are used in place when it is opened.
+//
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
+#ifdef _WIN32                                                                  //(OPENSWMM 5.1.913)
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
 #include <stdlib.h>
 #include <string.h>
 #include <malloc.h>
 #include <math.h>
+#include <omp.h>                                                               //(OPENSWMM 5.1.913)
 #include "headers.h"
 #include "lid.h"
+#include "mempool.h"                                                           //(OPENSWMM 5.1.913)
 #include "Seasonal.h"                                                          //(OPENSWMM 5.1.911)
 
 //-----------------------------------------------------------------------------
 //  Constants
 //-----------------------------------------------------------------------------
 static const int MAXERRS = 100;        // Max. input errors reported
+static const int MINPARLINES = 1000;  // Min. lines parsed in parallel         //(OPENSWMM 5.1.913)
+static const int MAXDIGITS = 15;      // Max. digits in a fast-parsed number   //(OPENSWMM 5.1.913)
+
+// Powers of 10 that are exactly representable as doubles                      //(OPENSWMM 5.1.913)
+static const double Pow10[] = {1.0e0, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5,
+    1.0e6, 1.0e7, 1.0e8, 1.0e9, 1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14,
+    1.0e15, 1.0e16, 1.0e17, 1.0e18, 1.0e19, 1.0e20, 1.0e21, 1.0e22};
+
+// Checks if a character is one of the token separators listed in SEPSTR       //(OPENSWMM 5.1.913)
+#define ISSEP(c) ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\r')
+
+//-----------------------------------------------------------------------------
+//  Data Structures
+//-----------------------------------------------------------------------------
+// Tokenized line of input saved from the object counting pass                 //(OPENSWMM 5.1.913)
+// (followed in memory by the line's text and its packed tokens)               //(OPENSWMM 5.1.913)
+struct InpLine
+{
+    struct InpLine* next;              // next saved line
+    long            lineCount;         // line number in input file
+    int             sect;              // input section of line
+    int             ntoks;             // number of tokens (-1 for a heading)
+};
+typedef struct InpLine TInpLine;                                               //(OPENSWMM 5.1.913)
+
+// Token found in a line of input that has not been copied or terminated       //(OPENSWMM 5.1.913)
+typedef struct
+{
+    char*  s;                          // start of token
+    long   len;                        // number of characters in token
+}  TTokSlice;
+
+//-----------------------------------------------------------------------------
+//  Compiled input files                                                       //(OPENSWMM 5.1.913)
+//-----------------------------------------------------------------------------
+//  A compiled input file holds a TInpBinHeader followed by the saved input
+//  lines of a project that passed validation. Each line is stored as an
+//  image of its TInpLine record (with a null next pointer) followed by its
+//  text and tokens, padded with zeros to an 8 byte boundary. The tokens of
+//  section headings are not stored.
+static const char InpBinMagic[8] = {'S','W','M','M','5','I','N','P'};
+enum  InpBinVersion {INPBIN_VERSION = 1};
+
+typedef struct
+{
+    char   magic[8];                   // identifies a compiled input file
+    int    version;                    // file format version
+    int    lineSize;                   // size of a TInpLine record
+    int    nLines;                     // number of saved lines
+    int    spare;                      // unused (keeps lines 8-byte aligned)
+}  TInpBinHeader;
+
+//-----------------------------------------------------------------------------
+//  Imported variables
+//-----------------------------------------------------------------------------
+extern char   ErrString[256];          // defined in ERROR.C                   //(OPENSWMM 5.1.913)
+#pragma omp threadprivate(ErrString)                                           //(OPENSWMM 5.1.913)
 
 //-----------------------------------------------------------------------------
 //  Shared variables
@@ -41,25 +119,51 @@ static int  Mobjects[MAX_OBJ_TYPES];   // Working number of objects of each type
 static int  Mnodes[MAX_NODE_TYPES];    // Working number of node objects
 static int  Mlinks[MAX_LINK_TYPES];    // Working number of link objects
 static int  Mevents;                   // Working number of event periods      //(5.1.011)
+static alloc_handle_t* InpPool;        // Memory pool for saved input lines    //(OPENSWMM 5.1.913)
+static TInpLine* FirstLine;            // First saved input line               //(OPENSWMM 5.1.913)
+static TInpLine* LastLine;             // Last saved input line                //(OPENSWMM 5.1.913)
+static TTokSlice Slice[MAXTOKS];      // Token slices from line of input       //(OPENSWMM 5.1.913)
+static char* InpMap;                   // Contents of memory-mapped input file //(OPENSWMM 5.1.913)
+static char* InpMapPos;                // Start of next line in InpMap         //(OPENSWMM 5.1.913)
+static char* InpMapEnd;                // End of InpMap                        //(OPENSWMM 5.1.913)
+static char* CompiledFile;             // Name of compiled input file to write //(OPENSWMM 5.1.913)
 
 //-----------------------------------------------------------------------------
 //  External Functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
 //  input_countObjects  (called by swmm_open in swmm5.c)
 //  input_readData      (called by swmm_open in swmm5.c)
+//  input_setCompiledFile (called by swmm_compile in swmm5.c)
 
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
 static int  addObject(int objType, char* id);
-static int  getTokens(char *s);
+static int  getTokens(char *s, long len);                                      //(OPENSWMM 5.1.913)
 static int  parseLine(int sect, char* line);
-static int  readOption(char* line);
+static int  readOption(void);                                                  //(OPENSWMM 5.1.913)
 static int  readTitle(char* line);
 static int  readControl(char* tok[], int ntoks);
 static int  readNode(int type);
 static int  readLink(int type);
 static int  readEvent(char* tok[], int ntoks);                                 //(5.1.011)
+static TInpLine* saveLine(char* line, long len, long lineCount);               //(OPENSWMM 5.1.913)
+static void addLine(TInpLine* inpLine, int sect);                              //(OPENSWMM 5.1.913)
+static int  restoreTokens(TInpLine* inpLine, char* tok[]);                     //(OPENSWMM 5.1.913)
+static void freeLines(void);                                                   //(OPENSWMM 5.1.913)
+static char* readLine(char* buffer, long* len);                                //(OPENSWMM 5.1.913)
+static int  mapInputFile(int copy);                                            //(OPENSWMM 5.1.913)
+static void unmapInputFile(void);                                              //(OPENSWMM 5.1.913)
+static int  getNumber(char* s, double* y);                                     //(OPENSWMM 5.1.913)
+static int  isMapSection(int sect);                                            //(OPENSWMM 5.1.913)
+static int  isIndependentSection(int sect);                                    //(OPENSWMM 5.1.913)
+static int  parseIndependentLine(int sect, char* tok[], int ntoks);            //(OPENSWMM 5.1.913)
+static int  parseSection(int sect, TInpLine* first, int n, int* errsum);       //(OPENSWMM 5.1.913)
+static unsigned int getKey(char* id);                                          //(OPENSWMM 5.1.913)
+static int  writeCompiledFile(char* fname);                                    //(OPENSWMM 5.1.913)
+static int  isCompiledFile(void);                                              //(OPENSWMM 5.1.913)
+static int  readCompiledFile(void);                                            //(OPENSWMM 5.1.913)
+static long getLineSize(TInpLine* inpLine, char* end);                         //(OPENSWMM 5.1.913)
 
 
 //=============================================================================
@@ -70,15 +174,24 @@ int input_countObjects()
 //  Output:  returns error code
 //  Purpose: reads input file to determine number of system objects.
 //
+//  Note:    each line is tokenized only once. Lines holding object data
+//           are saved to a memory pool so that input_readData() can
+//           parse them without reading the file a second time. When the
+//           input file can be memory-mapped its lines are read in place
+//           and may be of any length.
+//
 {
-    char  line[MAXLINE+1];             // line from input data file     
-    char  wLine[MAXLINE+1];            // working copy of input line   
-    char  *tok;                        // first string token of line          
+    char  buffer[MAXLINE+1];           // line from input data file
+    char* line;                        // start of line of input
+    char* comment;                     // ptr. to start of comment in input line
     int   sect = -1, newsect;          // input data sections          
     int   errcode = 0;                 // error code
     int   errsum = 0;                  // number of errors found                   
+    long  lineLength;                  // number of characters in input line
     int   i;
     long  lineCount = 0;
+    TInpLine* inpLine;                 // saved line of input
+    alloc_handle_t* idPool;            // memory pool for object ID names
 
     // --- initialize number of objects & set default values
     if ( ErrorCode ) return ErrorCode;
@@ -87,24 +200,73 @@ int input_countObjects()
     for (i = 0; i < MAX_NODE_TYPES; i++) Nnodes[i] = 0;
     for (i = 0; i < MAX_LINK_TYPES; i++) Nlinks[i] = 0;
 
-    // --- make pass through data file counting number of each object
-    while ( fgets(line, MAXLINE, Finp.file) != NULL )
+    // --- create a memory pool to hold tokenized input lines
+    //     (AllocInit makes the new pool the current one)
+    FirstLine = NULL;
+    LastLine = NULL;
+    idPool = AllocSetPool(NULL);
+    InpPool = AllocInit();
+    AllocSetPool(idPool);
+    if ( InpPool == NULL )
     {
-        // --- skip blank lines & those beginning with a comment
+        report_writeErrorMsg(ERR_MEMORY, "");
+        return ErrorCode;
+    }
+
+    // --- lines of a compiled input file were already tokenized & checked
+    if ( isCompiledFile() ) return readCompiledFile();
+
+    // --- make single pass through data file counting number of each
+    //     object and saving the tokens of each line of object data
+    mapInputFile(FALSE);
+    while ( (line = readLine(buffer, &lineLength)) != NULL )
+    {
+        // --- scan line for tokens
         lineCount++;
-        strcpy(wLine, line);           // make working copy of line
-        tok = strtok(wLine, SEPSTR);   // get first text token on line
-        if ( tok == NULL ) continue;
-        if ( *tok == ';' ) continue;
+        Ntokens = getTokens(line, lineLength);
+
+        // --- skip blank lines and comments
+        if ( Ntokens == 0 ) continue;
+        if ( *Slice[0].s == ';' ) continue;
+
+        // --- check if max. line length exceeded
+        //     (only lines read from an unmapped file have a limit)
+        if ( InpMap == NULL && lineLength >= MAXLINE )
+        {
+            // --- don't count comment if present
+            comment = strchr(line, ';');
+            if ( comment ) lineLength = comment - line;    // Pointer math here
+            if ( lineLength >= MAXLINE )
+            {
+                report_writeInputErrorMsg(ERR_LINE_LENGTH, sect, line,
+                                          lineCount);
+                errsum++;
+            }
+        }
+
+        // --- lines of map sections are not used so they aren't saved
+        if ( isMapSection(sect) && *Slice[0].s != '[' ) continue;
+
+        // --- copy line and its tokens to the input line pool
+        inpLine = saveLine(line, lineLength, lineCount);
+        if ( inpLine == NULL )
+        {
+            report_writeErrorMsg(ERR_MEMORY, "");
+            errsum++;
+            break;
+        }
+        line = (char *)(inpLine + 1);
 
         // --- check if line begins with a new section heading
-        if ( *tok == '[' )
+        if ( *Tok[0] == '[' )
         {
             // --- look for heading in list of section keywords
-            newsect = findmatch(tok, SectWords);
+            newsect = findmatch(Tok[0], SectWords);
             if ( newsect >= 0 )
             {
                 sect = newsect;
+                inpLine->ntoks = -1;
+                addLine(inpLine, sect);
                 continue;
             }
             else
@@ -115,21 +277,31 @@ int input_countObjects()
         }
 
         // --- if in OPTIONS section then read the option setting
-        //     otherwise add object and its ID name (tok) to project
-        if ( sect == s_OPTION ) errcode = readOption(line);
-        else if ( sect >= 0 )   errcode = addObject(sect, tok);
+        //     otherwise add object and its ID name to project, then
+        //     keep the line's tokens for parsing later on
+        else if ( sect >= 0 )
+        {
+            if ( sect == s_OPTION ) errcode = readOption();
+            else errcode = addObject(sect, Tok[0]);
+            if ( errcode == 0 ) addLine(inpLine, sect);
+        }
 
         // --- report any error found
         if ( errcode )
         {
             report_writeInputErrorMsg(errcode, sect, line, lineCount);
             errsum++;
-            if (errsum >= MAXERRS ) break;
+            if ( errsum >= MAXERRS ) break;
         }
     }
+    unmapInputFile();
 
     // --- set global error code if input errors were found
-    if ( errsum > 0 ) ErrorCode = ERR_INPUT;
+    if ( errsum > 0 )
+    {
+        ErrorCode = ERR_INPUT;
+        freeLines();
+    }
     return ErrorCode;
 }
 
@@ -139,22 +311,33 @@ int input_readData()
 //
 //  Input:   none
 //  Output:  returns error code
-//  Purpose: reads input file to determine input parameters for each object.
+//  Purpose: parses the input lines saved by input_countObjects() to
+//           determine input parameters for each object.
 //
 {
-    char  line[MAXLINE+1];        // line from input data file
-    char  wLine[MAXLINE+1];       // working copy of input line
-    char* comment;                // ptr. to start of comment in input line
-    int   sect, newsect;          // data sections
+    TInpLine* inpLine;            // saved line of input
+    TInpLine* nextLine;           // next saved line of input
+    char* line;                   // text of input line
+    int   sect;                   // data section
     int   inperr, errsum;         // error code & total error count
-    int   lineLength;             // number of characters in input line
-    int   i;
-    long  lineCount = 0;
+    int   i, n;
 
     // --- initialize working item count arrays
     //     (final counts in Mobjects, Mnodes & Mlinks should
     //      match those in Nobjects, Nnodes and Nlinks).
-    if ( ErrorCode ) return ErrorCode;
+    if ( ErrorCode )
+    {
+        freeLines();
+        return ErrorCode;
+    }
+
+    // --- save the lines to a compiled input file before parsing them
+    //     (some parsers alter the tokens they read)
+    if ( CompiledFile && writeCompiledFile(CompiledFile) )
+    {
+        freeLines();
+        return ErrorCode;
+    }
     error_setInpError(0, "");
     for (i = 0; i < MAX_OBJ_TYPES; i++)  Mobjects[i] = 0;
     for (i = 0; i < MAX_NODE_TYPES; i++) Mnodes[i] = 0;
@@ -167,76 +350,52 @@ int input_readData()
         Tseries[i].lastDate = StartDate + StartTime;
     }
 
-    // --- read each line from input file
+    // --- parse each saved line of input
     sect = 0;
     errsum = 0;
-    rewind(Finp.file);
-    while ( fgets(line, MAXLINE, Finp.file) != NULL )
+    for ( inpLine = FirstLine; inpLine != NULL; inpLine = inpLine->next )
     {
-        // --- make copy of line and scan for tokens
-        lineCount++;
-        strcpy(wLine, line);
-        Ntokens = getTokens(wLine);
-
-        // --- skip blank lines and comments
-        if ( Ntokens == 0 ) continue;
-        if ( *Tok[0] == ';' ) continue;
-
-        // --- check if max. line length exceeded
-        lineLength = strlen(line);
-        if ( lineLength >= MAXLINE )
-        {
-            // --- don't count comment if present
-            comment = strchr(line, ';');
-            if ( comment ) lineLength = comment - line;    // Pointer math here
-            if ( lineLength >= MAXLINE )
-            {
-                inperr = ERR_LINE_LENGTH;
-                report_writeInputErrorMsg(inperr, sect, line, lineCount);
-                errsum++;
-            }
-        }
-
         // --- check if at start of a new input section
-        if (*Tok[0] == '[')
+        if ( inpLine->ntoks < 0 )
         {
-            // --- match token against list of section keywords
-            newsect = findmatch(Tok[0], SectWords);
-            if (newsect >= 0)
-            {
-                // --- SPECIAL CASE FOR TRANSECTS
-                //     finish processing the last set of transect data
-                if ( sect == s_TRANSECT )
-                    transect_validate(Nobjects[TRANSECT]-1);
-
-                // --- begin a new input section
-                sect = newsect;
-                continue;
-            }
-            else
-            {
-                inperr = error_setInpError(ERR_KEYWORD, Tok[0]);
-                report_writeInputErrorMsg(inperr, sect, line, lineCount);
-                errsum++;
-                break;
-            }
+            // --- SPECIAL CASE FOR TRANSECTS
+            //     finish processing the last set of transect data
+            if ( sect == s_TRANSECT )
+                transect_validate(Nobjects[TRANSECT]-1);
+
+            // --- begin a new input section
+            sect = inpLine->sect;
+
+            // --- parse a long section of independent lines in parallel
+            if ( !isIndependentSection(sect) ) continue;
+            n = 0;
+            for ( nextLine = inpLine->next; nextLine && nextLine->ntoks >= 0;
+                  nextLine = nextLine->next ) n++;
+            if ( n < MINPARLINES ) continue;
+            if ( !parseSection(sect, inpLine->next, n, &errsum) ) continue;
+            if ( errsum > MAXERRS ) break;
+            while ( n-- > 0 ) inpLine = inpLine->next;
+            continue;
         }
 
         // --- otherwise parse tokens from input line
-        else
+        line = (char *)(inpLine + 1);
+        Ntokens = restoreTokens(inpLine, Tok);
+        inperr = parseLine(sect, line);
+        if ( inperr > 0 )
         {
-            inperr = parseLine(sect, line);
-            if ( inperr > 0 )
-            {
-                errsum++;
-                if ( errsum > MAXERRS ) report_writeLine(FMT19);
-                else report_writeInputErrorMsg(inperr, sect, line, lineCount);
-            }
+            errsum++;
+            if ( errsum > MAXERRS ) report_writeLine(FMT19);
+            else report_writeInputErrorMsg(inperr, sect, line,
+                                           inpLine->lineCount);
         }
 
-        // --- stop if reach end of file or max. error count
+        // --- stop if reach max. error count
         if (errsum > MAXERRS) break;
-    }   /* End of while */
+    }
+
+    // --- free the saved input lines
+    freeLines();
 
     // --- check for errors
     if (errsum > 0)  ErrorCode = ERR_INPUT;
@@ -245,6 +404,81 @@ int input_readData()
 
 //=============================================================================
 
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+void input_setCompiledFile(char* fname)
+//
+//  Input:   fname = name of a compiled input file (or NULL)
+//  Output:  none
+//  Purpose: sets the name of the compiled input file that input_readData()
+//           saves the project's input lines to (NULL if none).
+//
+{
+    CompiledFile = fname;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int  writeCompiledFile(char* fname)
+//
+//  Input:   fname = name of the compiled input file to create
+//  Output:  returns error code
+//  Purpose: saves the input lines read by input_countObjects() to a
+//           compiled input file.
+//
+{
+    static const char zeros[8] = {0};
+    int   ok;
+    long  len, pad;
+    FILE* f;
+    TInpLine* inpLine;
+    TInpLine  rec;
+    TInpBinHeader header;
+
+    f = fopen(fname, "wb");
+    if ( f == NULL )
+    {
+        report_writeErrorMsg(ERR_COMPILED_WRITE, fname);
+        return ErrorCode;
+    }
+
+    // --- write the file's header
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, InpBinMagic, sizeof(InpBinMagic));
+    header.version = INPBIN_VERSION;
+    header.lineSize = sizeof(TInpLine);
+    for ( inpLine = FirstLine; inpLine != NULL; inpLine = inpLine->next )
+        header.nLines++;
+    ok = ( fwrite(&header, sizeof(header), 1, f) == 1 );
+
+    // --- write each saved line's record, text & tokens
+    for ( inpLine = FirstLine; ok && inpLine != NULL; inpLine = inpLine->next )
+    {
+        memset(&rec, 0, sizeof(rec));
+        rec.lineCount = inpLine->lineCount;
+        rec.sect = inpLine->sect;
+        rec.ntoks = inpLine->ntoks;
+        len = getLineSize(inpLine, NULL);
+        pad = ((sizeof(TInpLine) + len + 7) & ~7L) - sizeof(TInpLine) - len;
+        ok = ( fwrite(&rec, sizeof(rec), 1, f) == 1 &&
+               fwrite(inpLine + 1, 1, len, f) == (size_t)len &&
+               fwrite(zeros, 1, pad, f) == (size_t)pad );
+    }
+    if ( fclose(f) != 0 ) ok = FALSE;
+
+    // --- don't leave a partly written file behind
+    if ( !ok )
+    {
+        remove(fname);
+        report_writeErrorMsg(ERR_COMPILED_WRITE, fname);
+    }
+    return ErrorCode;
+}
+
+//=============================================================================
+
 int  addObject(int objType, char* id)
 //
 //  Input:   objType = object type index
@@ -388,8 +622,8 @@ int  addObject(int objType, char* id)
             Nobjects[CURVE]++;
 
             // --- check for a conduit shape curve
-            id = strtok(NULL, SEPSTR);
-            if ( findmatch(id, CurveTypeWords) == SHAPE_CURVE )
+            id = Tok[1];                                                       //(OPENSWMM 5.1.913)
+            if ( id && findmatch(id, CurveTypeWords) == SHAPE_CURVE )          //(OPENSWMM 5.1.913)
                 Nobjects[SHAPE]++;
         }
         break;
@@ -412,7 +646,7 @@ int  addObject(int objType, char* id)
         // --- for TRANSECTS, ID name appears as second entry on X1 line
         if ( match(id, "X1") )
         {
-            id = strtok(NULL, SEPSTR);
+            id = Tok[1];                                                       //(OPENSWMM 5.1.913)
             if ( id ) 
             {
                 if ( !project_addObject(TRANSECT, id, Nobjects[TRANSECT]) )
@@ -646,16 +880,16 @@ int readControl(char* tok[], int ntoks)
 
 //=============================================================================
 
-int readOption(char* line)
+int readOption()                                                               //(OPENSWMM 5.1.913)
 //
-//  Input:   line = line of input data
+//  Input:   none
 //  Output:  returns error code
-//  Purpose: reads an input line containing a project option.
+//  Purpose: reads the tokens of an input line containing a project option.
 //
 {
-    Ntokens = getTokens(line);
     if ( Ntokens < 2 ) return 0;
-    return project_readOption(Tok[0], Tok[1]);
+    if ( Ntokens > 2 ) return project_readOption(Tok[0], Tok[1], Tok[2]);   //(OPENSWMM 5.1.913)
+    return project_readOption(Tok[0], Tok[1], "");
 }
 
 //=============================================================================
@@ -827,6 +1061,12 @@ int  getFloat(char *s, float *y)
 //
 {
     char *endptr;
+    double x;                                                                  //(OPENSWMM 5.1.913)
+    if ( getNumber(s, &x) )                                                    //(OPENSWMM 5.1.913)
+    {                                                                          //(OPENSWMM 5.1.913)
+        *y = (float)x;                                                         //(OPENSWMM 5.1.913)
+        return(1);                                                             //(OPENSWMM 5.1.913)
+    }                                                                          //(OPENSWMM 5.1.913)
     *y = (float) strtod(s, &endptr);
     if (*endptr > 0) return(0);
     return(1);
@@ -843,6 +1083,7 @@ int  getDouble(char *s, double *y)
 //
 {
     char *endptr;
+    if ( getNumber(s, y) ) return(1);                                          //(OPENSWMM 5.1.913)
     *y = strtod(s, &endptr);
     if (*endptr > 0) return(0);
     return(1);
@@ -850,51 +1091,735 @@ int  getDouble(char *s, double *y)
 
 //=============================================================================
 
-int  getTokens(char *s)
+int  getTokens(char *s, long len)                                              //(OPENSWMM 5.1.913)
 //
-//  Input:   s = a character string
+//  Input:   s = a line of text (need not be null-terminated)
+//           len = number of characters in s
 //  Output:  returns number of tokens found in s
-//  Purpose: scans a string for tokens, saving pointers to them
-//           in shared variable Tok[].
+//  Purpose: scans a line of text for tokens, saving the start and length
+//           of each in shared variable Slice[].
 //
 //  Notes:   Tokens can be separated by the characters listed in SEPSTR
 //           (spaces, tabs, newline, carriage return) which is defined
 //           in CONSTS.H. Text between quotes is treated as a single token.
+//           The text of s is left unchanged.
 //
 {
-    int  len, m, n;
-    char *c;
+    int  n = 0;
+    char *c, *end;
 
-    // --- begin with no tokens
-    for (n = 0; n < MAXTOKS; n++) Tok[n] = NULL;
-    n = 0;
-
-    // --- truncate s at start of comment 
-    c = strchr(s,';');
-    if (c) *c = '\0';
-    len = strlen(s);
+    // --- ignore text after start of comment
+    c = memchr(s, ';', len);
+    end = c ? c : s + len;
 
     // --- scan s for tokens until nothing left
-    while (len > 0 && n < MAXTOKS)
+    while (s < end && n < MAXTOKS)
     {
-        m = strcspn(s,SEPSTR);              // find token length 
-        if (m == 0) s++;                    // no token found
-        else
+        if ( ISSEP(*s) )                    // no token found
         {
-            if (*s == '"')                  // token begins with quote
-            {
-                s++;                        // start token after quote
-                len--;                      // reduce length of s
-                m = strcspn(s,"\"\n");      // find end quote or new line
-            }
-            s[m] = '\0';                    // null-terminate the token
-            Tok[n] = s;                     // save pointer to token 
-            n++;                            // update token count
-            s += m+1;                       // begin next token
+            s++;
+            continue;
         }
-        len -= m+1;                         // update length of s
+        if (*s == '"')                      // token begins with quote
+        {
+            s++;                            // start token after quote
+            for (c = s; c < end && *c != '"' && *c != '\n'; c++);
+        }
+        else for (c = s; c < end && !ISSEP(*c); c++);
+        Slice[n].s = s;                     // save start of token
+        Slice[n].len = c - s;               // save token length
+        n++;                                // update token count
+        s = c + 1;                          // begin next token
     }
     return(n);
 }
 
 //=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+TInpLine*  saveLine(char* line, long len, long lineCount)
+//
+//  Input:   line = start of line of text read from input file
+//           len = number of characters in line
+//           lineCount = line number of data file
+//  Output:  returns pointer to the saved line (NULL if out of memory)
+//  Purpose: copies a line of input along with its token slices to the
+//           input line memory pool and points Tok[] at the copied tokens.
+//
+//  Notes:   The line's text is stored after the TInpLine record followed
+//           by each of the line's tokens as a null-terminated string. A
+//           carriage return at the end of the line is dropped.
+//
+{
+    int   i;
+    int   crlf = FALSE;
+    long  size;
+    char* p;
+    TInpLine* inpLine;
+    alloc_handle_t* idPool;
+
+    // --- find memory needed for the line and its tokens
+    if ( len >= 2 && line[len-2] == '\r' && line[len-1] == '\n' )
+    {
+        crlf = TRUE;
+        len--;
+    }
+    size = sizeof(TInpLine) + len + 1;
+    for (i = 0; i < Ntokens; i++) size += Slice[i].len + 1;
+
+    // --- keep each allocation aligned on an 8 byte boundary
+    size = (size + 7) & ~7L;
+
+    // --- allocate the line from the input line pool
+    idPool = AllocSetPool(InpPool);
+    inpLine = (TInpLine *) Alloc(size);
+    AllocSetPool(idPool);
+    if ( inpLine == NULL ) return NULL;
+
+    // --- copy the line and its tokens
+    inpLine->next = NULL;
+    inpLine->lineCount = lineCount;
+    inpLine->sect = -1;
+    inpLine->ntoks = Ntokens;
+    p = (char *)(inpLine + 1);
+    memcpy(p, line, len);
+    if ( crlf ) p[len-1] = '\n';
+    p[len] = '\0';
+    p += len + 1;
+    for (i = 0; i < Ntokens; i++)
+    {
+        memcpy(p, Slice[i].s, Slice[i].len);
+        p[Slice[i].len] = '\0';
+        Tok[i] = p;
+        p += Slice[i].len + 1;
+    }
+    for (i = Ntokens; i < MAXTOKS; i++) Tok[i] = NULL;
+    return inpLine;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+void  addLine(TInpLine* inpLine, int sect)
+//
+//  Input:   inpLine = a line of input saved by saveLine()
+//           sect = input section of line
+//  Output:  none
+//  Purpose: adds a saved line of input to the list of lines to be parsed.
+//
+{
+    inpLine->sect = sect;
+    if ( LastLine ) LastLine->next = inpLine;
+    else FirstLine = inpLine;
+    LastLine = inpLine;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int  restoreTokens(TInpLine* inpLine, char* tok[])
+//
+//  Input:   inpLine = a saved line of input
+//  Output:  tok[] = array of pointers to the line's tokens;
+//           returns number of tokens
+//  Purpose: retrieves the tokens of a saved line of input.
+//
+{
+    int   n;
+    char* p = (char *)(inpLine + 1);
+
+    p += strlen(p) + 1;
+    for (n = 0; n < inpLine->ntoks; n++)
+    {
+        tok[n] = p;
+        p += strlen(p) + 1;
+    }
+    for (n = inpLine->ntoks; n < MAXTOKS; n++) tok[n] = NULL;
+    return inpLine->ntoks;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+void  freeLines()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the memory pool used to store saved input lines.
+//
+{
+    alloc_handle_t* idPool;
+
+    // --- lines read from a compiled input file are held in its mapping
+    unmapInputFile();
+    if ( InpPool == NULL ) return;
+    idPool = AllocSetPool(InpPool);
+    AllocFreePool();
+    AllocSetPool(idPool);
+    InpPool = NULL;
+    FirstLine = NULL;
+    LastLine = NULL;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+char*  readLine(char* buffer, long* len)
+//
+//  Input:   buffer = array of MAXLINE+1 characters
+//  Output:  len = number of characters in line;
+//           returns start of next line of input or NULL if none left
+//  Purpose: reads the next line of the input file.
+//
+//  Notes:   Lines of a memory-mapped input file are read in place and
+//           are not null-terminated. Otherwise up to MAXLINE-1 characters
+//           are read into buffer.
+//
+{
+    char* line;
+    char* c;
+
+    if ( InpMap )
+    {
+        if ( InpMapPos >= InpMapEnd ) return NULL;
+        line = InpMapPos;
+        c = memchr(line, '\n', InpMapEnd - line);
+        InpMapPos = c ? c + 1 : InpMapEnd;
+        *len = InpMapPos - line;
+
+        // --- as with fgets(), ignore text after a null character
+        c = memchr(line, '\0', *len);
+        if ( c ) *len = c - line;
+        return line;
+    }
+    if ( fgets(buffer, MAXLINE, Finp.file) == NULL ) return NULL;
+    *len = strlen(buffer);
+    return buffer;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int  mapInputFile(int copy)
+//
+//  Input:   copy = TRUE if the mapping is a private, writable copy
+//  Output:  returns TRUE if input file was memory-mapped, FALSE if not
+//  Purpose: maps the contents of the input file into memory.
+//
+{
+    char*  base = NULL;
+    size_t size = 0;
+
+#ifdef _WIN32
+    HANDLE        f, m;
+    LARGE_INTEGER fsize;
+
+    f = CreateFileA(Finp.name, GENERIC_READ, FILE_SHARE_READ, NULL,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if ( f == INVALID_HANDLE_VALUE ) return FALSE;
+    if ( GetFileSizeEx(f, &fsize) && fsize.QuadPart > 0 &&
+         (ULONGLONG)fsize.QuadPart <= (size_t)-1 )
+    {
+        size = (size_t)fsize.QuadPart;
+        m = CreateFileMappingA(f, NULL, copy ? PAGE_WRITECOPY : PAGE_READONLY,
+                               0, 0, NULL);
+        if ( m )
+        {
+            base = (char *)MapViewOfFile(m, copy ? FILE_MAP_COPY : FILE_MAP_READ,
+                                         0, 0, 0);
+            CloseHandle(m);
+        }
+    }
+    CloseHandle(f);
+#else
+    int         f;
+    struct stat fstats;
+
+    f = open(Finp.name, O_RDONLY);
+    if ( f < 0 ) return FALSE;
+    if ( fstat(f, &fstats) == 0 && S_ISREG(fstats.st_mode) &&
+         fstats.st_size > 0 )
+    {
+        size = (size_t)fstats.st_size;
+        base = (char *)mmap(NULL, size, copy ? PROT_READ | PROT_WRITE :
+                            PROT_READ, MAP_PRIVATE, f, 0);
+        if ( base == MAP_FAILED ) base = NULL;
+#ifdef MADV_SEQUENTIAL
+        else madvise(base, size, MADV_SEQUENTIAL);
+#endif
+    }
+    close(f);
+#endif
+    if ( base == NULL ) return FALSE;
+    InpMap = base;
+    InpMapPos = base;
+    InpMapEnd = base + size;
+    return TRUE;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+void  unmapInputFile()
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: releases the memory mapping of the input file.
+//
+{
+    if ( InpMap == NULL ) return;
+#ifdef _WIN32
+    UnmapViewOfFile(InpMap);
+#else
+    munmap(InpMap, InpMapEnd - InpMap);
+#endif
+    InpMap = NULL;
+    InpMapPos = NULL;
+    InpMapEnd = NULL;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int  getNumber(char* s, double* y)
+//
+//  Input:   s = a character string
+//  Output:  y = converted value of s,
+//           returns 1 if s was converted, 0 if it must be left to strtod()
+//  Purpose: quickly converts a string holding a plain decimal number.
+//
+//  Notes:   Only numbers with at most MAXDIGITS significant digits and a
+//           power of 10 no larger than 22 are converted. Both are then
+//           held exactly as doubles so a single multiply or divide gives
+//           the same correctly rounded result that strtod() would.
+//
+{
+    char*  p = s;
+    int    negative = FALSE;
+    int    digits = 0;                 // number of digits read
+    int    sigDigits = 0;              // number of significant digits read
+    int    e = 0;                      // power of 10 applied to mantissa
+    int    exponent = 0;               // value of exponent field
+    int    expSign = 1;                // sign of exponent field
+    double m = 0.0;                    // mantissa
+
+    // --- sign
+    if ( *p == '-' )
+    {
+        negative = TRUE;
+        p++;
+    }
+    else if ( *p == '+' ) p++;
+
+    // --- whole number digits
+    for ( ; *p >= '0' && *p <= '9'; p++ )
+    {
+        digits++;
+        if ( m == 0.0 && *p == '0' ) continue;
+        if ( ++sigDigits > MAXDIGITS ) return 0;
+        m = 10.0 * m + (*p - '0');
+    }
+
+    // --- fractional digits
+    if ( *p == '.' )
+    {
+        for ( p++; *p >= '0' && *p <= '9'; p++ )
+        {
+            digits++;
+            e--;
+            if ( m == 0.0 && *p == '0' ) continue;
+            if ( ++sigDigits > MAXDIGITS ) return 0;
+            m = 10.0 * m + (*p - '0');
+        }
+    }
+    if ( digits == 0 ) return 0;
+
+    // --- exponent
+    if ( *p == 'e' || *p == 'E' )
+    {
+        p++;
+        if ( *p == '-' )
+        {
+            expSign = -1;
+            p++;
+        }
+        else if ( *p == '+' ) p++;
+        if ( *p < '0' || *p > '9' ) return 0;
+        for ( ; *p >= '0' && *p <= '9'; p++ )
+        {
+            if ( exponent < 1000 ) exponent = 10 * exponent + (*p - '0');
+        }
+        e += expSign * exponent;
+    }
+
+    // --- anything else is left to strtod()
+    if ( *p != '\0' ) return 0;
+
+    // --- apply power of 10 to mantissa
+    if ( m != 0.0 )
+    {
+        if ( e < -22 || e > 22 ) return 0;
+        if ( e < 0 ) m /= Pow10[-e];
+        else         m *= Pow10[e];
+    }
+    *y = negative ? -m : m;
+    return 1;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int  isMapSection(int sect)
+//
+//  Input:   sect = input section index
+//  Output:  returns TRUE if section only holds data for map display
+//  Purpose: identifies input sections whose lines are ignored by parseLine().
+//
+{
+    switch (sect)
+    {
+      case s_COORDINATE:
+      case s_VERTICES:
+      case s_POLYGON:
+      case s_LABEL:
+      case s_SYMBOL:
+      case s_BACKDROP:
+      case s_TAG:
+      case s_PROFILE:
+      case s_MAP:
+        return TRUE;
+      default: return FALSE;
+    }
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int  isIndependentSection(int sect)
+//
+//  Input:   sect = input section index
+//  Output:  returns TRUE if section's lines can be parsed in parallel
+//  Purpose: identifies input sections whose lines only change the data
+//           of the object named in their first token.
+//
+{
+    switch (sect)
+    {
+      case s_SUBAREA:
+      case s_INFIL:
+      case s_XSECTION:
+      case s_TIMESERIES:
+        return TRUE;
+      default: return FALSE;
+    }
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int  parseIndependentLine(int sect, char* tok[], int ntoks)
+//
+//  Input:   sect = input section of line
+//           tok[] = array of string tokens
+//           ntoks = number of tokens
+//  Output:  returns error code or 0 if no error found
+//  Purpose: parses a tokenized line of a section listed in
+//           isIndependentSection().
+//
+{
+    switch (sect)
+    {
+      case s_SUBAREA:
+        return subcatch_readSubareaParams(tok, ntoks);
+
+      case s_INFIL:
+        return infil_readParams(InfilModel, tok, ntoks);
+
+      case s_XSECTION:
+        return link_readXsectParams(tok, ntoks);
+
+      case s_TIMESERIES:
+        return table_readTimeseries(tok, ntoks);
+
+      default: return 0;
+    }
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int  parseSection(int sect, TInpLine* first, int n, int* errsum)
+//
+//  Input:   sect = input section being parsed
+//           first = first saved line of the section
+//           n = number of lines in the section
+//           errsum = number of input errors found so far
+//  Output:  errsum = updated number of input errors found;
+//           returns TRUE if the section was parsed, FALSE if it must be
+//           parsed one line at a time (single thread or out of memory)
+//  Purpose: parses the lines of an independent input section in parallel.
+//
+//  Notes:   All lines naming the same object (ignoring case) are parsed
+//           by the same thread in file order, so the results match
+//           those of parsing the lines one after another. Errors are
+//           reported afterwards in file order.
+//
+{
+    int        i;
+    int        nThreads;
+    int*       errs;
+    char**     errStrings;
+    TInpLine** lines;
+    unsigned char* owner;
+
+    // --- use the number of threads requested for the project
+    //     (but no more than an owner index can hold)
+    nThreads = NumThreads;
+    if ( nThreads <= 0 ) nThreads = omp_get_max_threads();
+    nThreads = MIN(nThreads, 256);
+    if ( nThreads < 2 ) return FALSE;
+
+    // --- allocate arrays of lines, their owning threads & their errors
+    lines = (TInpLine **) malloc(n * sizeof(TInpLine *));
+    owner = (unsigned char *) malloc(n * sizeof(unsigned char));
+    errs = (int *) calloc(n, sizeof(int));
+    errStrings = (char **) calloc(n, sizeof(char *));
+    if ( !lines || !owner || !errs || !errStrings )
+    {
+        FREE(lines);
+        FREE(owner);
+        FREE(errs);
+        FREE(errStrings);
+        return FALSE;
+    }
+    for ( i = 0; i < n; i++ )
+    {
+        lines[i] = first;
+        first = first->next;
+    }
+
+#pragma omp parallel num_threads(nThreads)
+{
+    char* tok[MAXTOKS];
+    char* id;
+    int   j, ntoks, err;
+    int   t = omp_get_thread_num();
+    int   nt = omp_get_num_threads();
+
+    // --- assign each line to a thread by the ID name it refers to
+    #pragma omp for
+    for ( j = 0; j < n; j++ )
+    {
+        id = (char *)(lines[j] + 1);
+        id += strlen(id) + 1;
+        owner[j] = (unsigned char)(getKey(id) % nt);
+    }
+
+    // --- each thread parses the lines it owns in file order
+    for ( j = 0; j < n; j++ )
+    {
+        if ( owner[j] != t ) continue;
+        ntoks = restoreTokens(lines[j], tok);
+        err = parseIndependentLine(sect, tok, ntoks);
+        if ( err > 0 )
+        {
+            errs[j] = err;
+            errStrings[j] = (char *) malloc(strlen(ErrString) + 1);
+            if ( errStrings[j] ) strcpy(errStrings[j], ErrString);
+        }
+    }
+}
+
+    // --- report any errors in the order they appear in the file
+    for ( i = 0; i < n; i++ )
+    {
+        if ( errs[i] == 0 ) continue;
+        (*errsum)++;
+        if ( *errsum > MAXERRS )
+        {
+            report_writeLine(FMT19);
+            break;
+        }
+        error_setInpError(errs[i], errStrings[i] ? errStrings[i] : "");
+        report_writeInputErrorMsg(errs[i], sect, (char *)(lines[i] + 1),
+                                  lines[i]->lineCount);
+    }
+
+    // --- free allocated arrays
+    for ( i = 0; i < n; i++ ) FREE(errStrings[i]);
+    FREE(lines);
+    FREE(owner);
+    FREE(errs);
+    FREE(errStrings);
+    return TRUE;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+unsigned int  getKey(char* id)
+//
+//  Input:   id = ID name of an object
+//  Output:  returns a hash key for the ID name
+//  Purpose: finds a hash key that is the same for all ID names that
+//           match without regard to case.
+//
+{
+    unsigned int key = 0;
+    while ( *id )
+    {
+        key = 31 * key + UCHAR(*id);
+        id++;
+    }
+    return key;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int  isCompiledFile()
+//
+//  Input:   none
+//  Output:  returns TRUE if the input file is a compiled input file
+//  Purpose: checks if the input file starts with the compiled file marker.
+//
+{
+    char magic[sizeof(InpBinMagic)];
+    int  result = FALSE;
+
+    if ( Finp.file == NULL ) return FALSE;
+    if ( fread(magic, 1, sizeof(magic), Finp.file) == sizeof(magic) &&
+         memcmp(magic, InpBinMagic, sizeof(magic)) == 0 ) result = TRUE;
+    rewind(Finp.file);
+    return result;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int  readCompiledFile()
+//
+//  Input:   none
+//  Output:  returns error code
+//  Purpose: adds the objects, options and input lines held in a compiled
+//           input file to the project.
+//
+//  Notes:   The file is mapped into memory as a private copy so that its
+//           lines can be linked together and parsed in place. The mapping
+//           is released by freeLines().
+//
+{
+    int   errcode;
+    int   errsum = 0;
+    int   nLines = 0;
+    long  len;
+    char* p;
+    TInpLine* inpLine;
+    TInpBinHeader* header;
+
+    // --- map the file and check that its format is the one in use
+    if ( !mapInputFile(TRUE) )
+    {
+        report_writeErrorMsg(ERR_COMPILED_READ, Finp.name);
+        return ErrorCode;
+    }
+    header = (TInpBinHeader *)InpMap;
+    if ( InpMapEnd - InpMap < (long)sizeof(TInpBinHeader) ||
+         header->version != INPBIN_VERSION ||
+         header->lineSize != sizeof(TInpLine) ||
+         InpMapEnd[-1] != '\0' )
+    {
+        unmapInputFile();
+        report_writeErrorMsg(ERR_COMPILED_READ, Finp.name);
+        return ErrorCode;
+    }
+
+    // --- examine each saved line
+    p = InpMap + sizeof(TInpBinHeader);
+    while ( p < InpMapEnd )
+    {
+        // --- check that the line's contents lie within the file
+        inpLine = (TInpLine *)p;
+        if ( InpMapEnd - p < (long)sizeof(TInpLine) ) break;
+        if ( inpLine->sect < 0 || inpLine->sect > s_Seasonal ) break;
+        if ( inpLine->ntoks < -1 || inpLine->ntoks == 0 ||
+             inpLine->ntoks > MAXTOKS ) break;
+        len = getLineSize(inpLine, InpMapEnd);
+        if ( len < 0 ) break;
+        p += (sizeof(TInpLine) + len + 7) & ~7L;
+        inpLine->next = NULL;
+        nLines++;
+
+        // --- keep section headings
+        if ( inpLine->ntoks < 0 )
+        {
+            addLine(inpLine, inpLine->sect);
+            continue;
+        }
+
+        // --- read an option setting or add the line's object to project
+        Ntokens = restoreTokens(inpLine, Tok);
+        if ( inpLine->sect == s_OPTION ) errcode = readOption();
+        else errcode = addObject(inpLine->sect, Tok[0]);
+        if ( errcode == 0 )
+        {
+            addLine(inpLine, inpLine->sect);
+            continue;
+        }
+        report_writeInputErrorMsg(errcode, inpLine->sect,
+                                  (char *)(inpLine + 1), inpLine->lineCount);
+        errsum++;
+        if ( errsum >= MAXERRS ) break;
+    }
+
+    // --- check for lines that were not complete or are missing
+    if ( (p < InpMapEnd || nLines != header->nLines) && errsum < MAXERRS )
+        report_writeErrorMsg(ERR_COMPILED_READ, Finp.name);
+    if ( errsum > 0 ) ErrorCode = ERR_INPUT;
+    if ( ErrorCode ) freeLines();
+    return ErrorCode;
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+long  getLineSize(TInpLine* inpLine, char* end)
+//
+//  Input:   inpLine = a saved line of input
+//           end = end of the memory holding the line (or NULL if unknown)
+//  Output:  returns number of characters in the line's text and tokens,
+//           including their null terminators, or -1 if they run past end
+//  Purpose: finds the size of the text & tokens that follow a saved line's
+//           TInpLine record (tokens of section headings are not counted).
+//
+{
+    int   n;
+    int   nstrings = MAX(inpLine->ntoks, 0) + 1;
+    char* start = (char *)(inpLine + 1);
+    char* s = start;
+
+    for (n = 0; n < nstrings; n++)
+    {
+        if ( end && s >= end ) return -1;
+        s += strlen(s) + 1;
+    }
+    return s - start;
+}
+
+//=============================================================================
@@ -89,6 +89,10 @@ char* OptionWords[]        = { w_FLOW_UNITS,        w_INFIL_MODEL,
                                w_SYS_FLOW_TOL,      w_LAT_FLOW_TOL,
                                w_IGNORE_RDII,       w_MIN_ROUTE_STEP,          //(5.1.008)
 	w_NUM_THREADS,       w_Water_Age,	   //(OPENSWMM 5.1.912)
+                               w_SOLVER_METHOD,     w_MULTIRATE_CLASSES,       //(OPENSWMM 5.1.913)
+                               w_SOLVER_ACCEL,      w_SOLVER_PREDICTOR,
+                               w_GEOMETRY_TOL,      w_CHECK_GEOM_TABLES,
+                               w_STORAGE_TOL,       w_FRICTION_TABLE,
     NULL};                     //(5.1.008)
 char* OrificeTypeWords[]   = { w_SIDE, w_BOTTOM, NULL};
 char* OutfallTypeWords[]   = { w_FREE, w_NORMAL, w_FIXED, w_TIDAL,
@@ -137,6 +141,8 @@ char* SectWords[]          = { ws_TITLE,          ws_OPTION,
                                ws_ADJUST,         ws_EVENT,                    //(5.1.011)
 							   ws_Seasonal,       NULL};					   // (OPENSWMM 5.1.911)
 char* SnowmeltWords[]      = { w_PLOWABLE, w_IMPERV, w_PERV, w_REMOVAL, NULL};
+char* SolverAccelWords[]   = { w_NONE, w_ANDERSON, NULL};                       //(OPENSWMM 5.1.913)
+char* SolverMethodWords[]  = { w_PICARD, w_NEWTON, NULL};                       //(OPENSWMM 5.1.913)
 char* TempKeyWords[]       = { w_TIMESERIES, w_FILE, w_WINDSPEED, w_SNOWMELT,
                                w_ADC, NULL};
 char* TransectKeyWords[]   = { w_NC, w_X1, w_GR, NULL};
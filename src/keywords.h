@@ -51,6 +51,8 @@ extern char* RouteModelWords[];
 extern char* RuleKeyWords[];
 extern char* SectWords[];
 extern char* SnowmeltWords[];
+extern char* SolverAccelWords[];                                              //(OPENSWMM 5.1.913)
+extern char* SolverMethodWords[];                                             //(OPENSWMM 5.1.913)
 extern char* TempKeyWords[];
 extern char* TransectKeyWords[];
 extern char* TreatTypeWords[];
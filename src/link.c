@@ -759,7 +759,7 @@ double  link_getYnorm(int j, double q)
 //
 {
     int    k;
-    double s, a, y;
+    double s, y;                                                               //(OPENSWMM 5.1.913)
 
     if ( Link[j].type != CONDUIT ) return 0.0;
     if ( Link[j].xsect.type == DUMMY ) return 0.0;
@@ -768,8 +768,7 @@ double  link_getYnorm(int j, double q)
     if ( q > Conduit[k].qMax ) q = Conduit[k].qMax;
     if ( q <= 0.0 ) return 0.0;
     s = q / Conduit[k].beta;
-    a = xsect_getAofS(&Link[j].xsect, s);
-    y = xsect_getYofA(&Link[j].xsect, a);
+    y = xsect_getYofS(&Link[j].xsect, s);                                      //(OPENSWMM 5.1.913)
     return y;
 }
 
@@ -1017,6 +1016,9 @@ void  conduit_validate(int j, int k)
     }
     if ( ErrorCode ) return;
 
+    // --- tabulate the xsection's inverse geometry if called for
+    if ( GeometryTol > 0.0 ) xsect_createInvTables(&Link[j].xsect);          //(OPENSWMM 5.1.913)
+
     // --- check for negative offsets
     if ( Link[j].offset1 < 0.0 )
     {
@@ -1055,6 +1057,8 @@ void  conduit_validate(int j, int k)
     if ( RouteModel == DW && Link[j].xsect.type == FORCE_MAIN )
     {
         roughness = forcemain_getEquivN(j, k);
+        if ( FricFactorTable && ForceMainEqn == D_W )                          //(OPENSWMM 5.1.913)
+            forcemain_createFricTable();
     }
 
     // --- adjust roughness for meandering natural channels
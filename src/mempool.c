@@ -8,6 +8,9 @@
 //
 //  Modified by L. Rossman, 8/13/94.
 //
+//  Modified for OpenSWMM 5.1.913 so that a request larger than
+//  ALLOC_BLOCK_SIZE receives a block of its own.
+//
 //  AllocInit()     - create an alloc pool, returns the old pool handle
 //  Alloc()         - allocate memory
 //  AllocReset()    - reset the current pool
@@ -62,21 +65,22 @@ static alloc_root_t *root;
 **  Private routine to allocate a header and memory block.
 */
 
-static alloc_hdr_t *AllocHdr(void);
+static alloc_hdr_t *AllocHdr(long);                                            //(OPENSWMM 5.1.913)
                 
-static alloc_hdr_t * AllocHdr()
+static alloc_hdr_t * AllocHdr(long size)                                       //(OPENSWMM 5.1.913)
 {
     alloc_hdr_t     *hdr;
     char            *block;
 
-    block = (char *) malloc(ALLOC_BLOCK_SIZE);
+    if (size < ALLOC_BLOCK_SIZE) size = ALLOC_BLOCK_SIZE;                      //(OPENSWMM 5.1.913)
+    block = (char *) malloc(size);                                             //(OPENSWMM 5.1.913)
     hdr   = (alloc_hdr_t *) malloc(sizeof(alloc_hdr_t));
 
     if (hdr == NULL || block == NULL) return(NULL);
     hdr->block = block;
     hdr->free  = block;
     hdr->next  = NULL;
-    hdr->end   = block + ALLOC_BLOCK_SIZE;
+    hdr->end   = block + size;                                                 //(OPENSWMM 5.1.913)
 
     return(hdr);
 }
@@ -95,7 +99,7 @@ alloc_handle_t * AllocInit()
 
     root = (alloc_root_t *) malloc(sizeof(alloc_root_t));
     if (root == NULL) return(NULL);
-    if ( (root->first = AllocHdr()) == NULL) return(NULL);
+    if ( (root->first = AllocHdr(ALLOC_BLOCK_SIZE)) == NULL) return(NULL);     //(OPENSWMM 5.1.913)
     root->current = root->first;
     newpool = (alloc_handle_t *) root;
     return(newpool);
@@ -127,9 +131,9 @@ char * Alloc(long size)
 
     if (hdr->free >= hdr->end)
     {
-        /* Is the next block already allocated? */
+        /* Is the next block already allocated and big enough? */
 
-        if (hdr->next != NULL)
+        if (hdr->next != NULL && hdr->next->end - hdr->next->block >= size)    //(OPENSWMM 5.1.913)
         {
             /* re-use block */
             hdr->next->free = hdr->next->block;
@@ -138,7 +142,9 @@ char * Alloc(long size)
         else
         {
             /* extend the pool with a new block */
-            if ( (hdr->next = AllocHdr()) == NULL) return(NULL);
+            alloc_hdr_t *next = hdr->next;                                     //(OPENSWMM 5.1.913)
+            if ( (hdr->next = AllocHdr(size)) == NULL) return(NULL);           //(OPENSWMM 5.1.913)
+            hdr->next->next = next;                                            //(OPENSWMM 5.1.913)
             root->current = hdr->next;
         }
 
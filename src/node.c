@@ -23,6 +23,13 @@
 //   Build 5.1.010:
 //   - Storage losses now based on node's new volume instead of old volume.
 //
+//   OpenSWMM 5.1.913:
+//   - When the STORAGE_TABLE_TOL option is set, storage units with a
+//     functional area curve that has a constant term find their depth by
+//     interpolating a table of depth v. volume built when the node is
+//     validated. Grid intervals where interpolation misses the tolerance
+//     use the Newton solution instead.
+//
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -32,6 +39,9 @@
 #include "headers.h"
 #include "findroot.h"
 
+#define  MIN_DEPTH_INTERVALS  64    // initial # intervals in a depth table    //(OPENSWMM 5.1.913)
+#define  MAX_DEPTH_INTERVALS  4096  // max. # intervals in a depth table
+
 //-----------------------------------------------------------------------------                  
 //  Local Declarations
 //-----------------------------------------------------------------------------
@@ -76,6 +86,9 @@ static double storage_getDepth(int j, double v);
 static double storage_getVolume(int j, double d);
 static double storage_getSurfArea(int j, double d);
 static void   storage_getVolDiff(double y, double* f, double* df, void* p);
+static double storage_findDepth(int k, double v, double dFull);                //(OPENSWMM 5.1.913)
+static void   storage_createDepthTable(int j);
+static int    storage_lookupDepth(TInvTable* table, double u, double* x);
 static double storage_getOutflow(int j, int i);
 static double storage_getLosses(int j, double tStep);
 
@@ -144,6 +157,7 @@ void  node_setParams(int j, int type, int k, double x[])
         Outfall[k].fixedStage  = x[2] / UCF(LENGTH);
         Outfall[k].tideCurve   = (int)x[3];
         Outfall[k].stageSeries = (int)x[4];
+        Outfall[k].stageCursor = 0;
         Outfall[k].hasFlapGate = (char)x[5];
 
 ////  Following code segment added to release 5.1.008.  ////                   //(5.1.008)
@@ -207,6 +221,10 @@ void  node_validate(int j)
 
     if ( Node[j].type == DIVIDER ) divider_validate(j);
 
+    // --- tabulate a storage unit's depth v. volume if called for
+    if ( Node[j].type == STORAGE && StorageTol > 0.0 )                         //(OPENSWMM 5.1.913)
+        storage_createDepthTable(j);
+
     // --- initialize dry weather inflows
     inflow = Node[j].dwfInflow;
     while (inflow)
@@ -749,7 +767,7 @@ double storage_getDepth(int j, double v)
     int    k = Node[j].subIndex;
     int    i = Storage[k].aCurve;
     double d, e;
-	TStorageVol storageVol;
+    TInvTable* table = Storage[k].dOfV;                                        //(OPENSWMM 5.1.913)
 
     // --- return max depth if a max. volume has been computed
     //     and volume is > max. volume
@@ -774,13 +792,13 @@ double storage_getDepth(int j, double v)
             e = 1.0 / (Storage[k].aExpon + 1.0);
             d = pow(v / (Storage[k].aCoeff * e), e);
         }
+        else if ( table && storage_lookupDepth(table, v / table->ref, &d) )   //(OPENSWMM 5.1.913)
+        {
+            d *= Node[j].fullDepth * UCF(LENGTH);
+        }
         else
         {
-            storageVol.k = k;
-            storageVol.v = v;
-            d = v / (Storage[k].aConst + Storage[k].aCoeff);
-            findroot_Newton(0.0, Node[j].fullDepth*UCF(LENGTH), &d,
-                            0.001, storage_getVolDiff, &storageVol);            
+            d = storage_findDepth(k, v, Node[j].fullDepth*UCF(LENGTH));
         }
         d /= UCF(LENGTH);
         if ( d > Node[j].fullDepth ) d = Node[j].fullDepth;
@@ -819,6 +837,133 @@ void  storage_getVolDiff(double y, double* f, double* df, void* p)
 
 //=============================================================================
 
+////  New functions added to release 5.1.913.  ////                            //(OPENSWMM 5.1.913)
+
+double storage_findDepth(int k, double v, double dFull)
+//
+//  Input:   k = storage unit index
+//           v = volume (user units)
+//           dFull = full depth (user units)
+//  Output:  returns depth (user units)
+//  Purpose: solves a storage unit's functional volume v. depth relation
+//           for depth using Newton's method.
+//
+{
+    double d;
+    TStorageVol storageVol;
+
+    storageVol.k = k;
+    storageVol.v = v;
+    d = v / (Storage[k].aConst + Storage[k].aCoeff);
+    findroot_Newton(0.0, dFull, &d, 0.001, storage_getVolDiff, &storageVol);
+    return d;
+}
+
+//=============================================================================
+
+void storage_createDepthTable(int j)
+//
+//  Input:   j = node index
+//  Output:  none
+//  Purpose: tabulates the depth of a storage unit with a functional area
+//           curve on a grid of evenly spaced volumes.
+//
+//  NOTE: the table is built only for curves that need a Newton solution
+//        for depth. Interpolation is checked at the quarter points of each
+//        grid interval against half of the STORAGE_TABLE_TOL tolerance;
+//        intervals that fail use the Newton solution instead. The grid is
+//        refined until no more than 1 in 32 intervals fail.
+//
+{
+    int    k = Node[j].subIndex;
+    int    n, i, q, nExact;
+    double dFull, vFull, e, u, x;
+    TInvTable* table = NULL;
+
+    // --- check that the curve is one solved by Newton's method
+    if ( Storage[k].aCurve >= 0 || Storage[k].aExpon == 0.0 ||
+         Storage[k].aConst == 0.0 ) return;
+    dFull = Node[j].fullDepth * UCF(LENGTH);
+    if ( dFull <= 0.0 ) return;
+    e = Storage[k].aExpon + 1.0;
+    vFull = Storage[k].aConst * dFull + Storage[k].aCoeff / e * pow(dFull, e);
+    if ( vFull <= 0.0 ) return;
+
+    for (n = MIN_DEPTH_INTERVALS; ; n *= 2)
+    {
+        // --- allocate a table with n grid intervals
+        if ( table )
+        {
+            FREE(table->x);
+            FREE(table->exact);
+            FREE(table);
+        }
+        table = (TInvTable *) calloc(1, sizeof(TInvTable));
+        if ( table == NULL ) return;
+        table->n = n;
+        table->ref = vFull;
+        table->x = (double *) malloc((n+1) * sizeof(double));
+        table->exact = (char *) calloc(n, sizeof(char));
+        if ( table->x == NULL || table->exact == NULL )
+        {
+            FREE(table->x);
+            FREE(table->exact);
+            FREE(table);
+            return;
+        }
+
+        // --- find normalized depth at each grid point
+        for (i = 0; i <= n; i++)
+            table->x[i] = storage_findDepth(k, vFull * i / n, dFull) / dFull;
+
+        // --- flag intervals where interpolation is not accurate enough
+        nExact = 0;
+        for (i = 0; i < n; i++)
+        {
+            for (q = 1; q <= 3; q++)
+            {
+                u = (i + 0.25 * q) / n;
+                x = table->x[i] + 0.25 * q * (table->x[i+1] - table->x[i]);
+                if ( fabs(x - storage_findDepth(k, vFull * u, dFull) / dFull)
+                     > 0.5 * StorageTol )
+                {
+                    table->exact[i] = TRUE;
+                    nExact++;
+                    break;
+                }
+            }
+        }
+        if ( 32 * nExact <= n || n >= MAX_DEPTH_INTERVALS ) break;
+    }
+    Storage[k].dOfV = table;
+}
+
+//=============================================================================
+
+int storage_lookupDepth(TInvTable* table, double u, double* x)
+//
+//  Input:   table = ptr. to a storage unit's depth table
+//           u = volume / full volume
+//  Output:  x = interpolated depth / full depth;
+//           returns TRUE if u lies in a grid interval that can be
+//           interpolated, FALSE if the Newton solution must be used
+//  Purpose: interpolates a storage unit's table of depth v. volume.
+//
+{
+    int    i;
+    double t;
+
+    if ( u < 0.0 ) return FALSE;
+    t = u * table->n;
+    if ( t >= table->n ) return FALSE;
+    i = (int)t;
+    if ( table->exact[i] ) return FALSE;
+    *x = table->x[i] + (t - i) * (table->x[i+1] - table->x[i]);
+    return TRUE;
+}
+
+//=============================================================================
+
 double storage_getVolume(int j, double d)
 //
 //  Input:   j = node index
@@ -1321,8 +1466,8 @@ void outfall_setOutletDepth(int j, double yNorm, double yCrit, double z)
       case TIMESERIES_OUTFALL:
         k = Outfall[i].stageSeries;
         currentDate = StartDateTime + NewRoutingTime / MSECperDAY;
-        stage = table_tseriesLookup(&Tseries[k], currentDate, TRUE) /
-                UCF(LENGTH);
+        stage = table_tseriesLookupAt(&Tseries[k], &Outfall[i].stageCursor,    //(OPENSWMM 5.1.913)
+                                      currentDate, TRUE) / UCF(LENGTH);
         break;
       default: stage = Node[j].invertElev;
     }
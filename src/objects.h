@@ -91,6 +91,14 @@ typedef struct
    TTableEntry*  lastEntry;       // last data point
    TTableEntry*  thisEntry;       // current data point
    TFile         file;            // external data file
+   int           nPoints;         // number of points in x/y arrays          //(OPENSWMM 5.1.913)
+   double*       xPoints;         // x-values of data points
+   double*       yPoints;         // y-values of data points
+   double*       aPoints;         // area under curve up to each point
+   double        dxGrid;          // x-value spacing if uniform (else 0)
+   int           yFalls;          // first point whose y-value decreases
+   void*         fileMap;         // contents of a memory-mapped binary file
+   int           thisPoint;       // current point of a memory-mapped file
 }  TTable;
 
 
@@ -135,6 +143,7 @@ typedef struct
 {
    int           dataSource;      // data from time series or file 
    int           tSeries;         // temperature data time series index
+   int           tsCursor;        // position in temperature time series
    DateTime      fileStartDate;   // starting date of data read from file
    double        elev;            // elev. of study area (ft)
    double        anglat;          // latitude (degrees)
@@ -426,6 +435,7 @@ struct ExtInflow
    int            param;         // pollutant index (flow = -1)
    int            type;          // CONCEN or MASS
    int            tSeries;       // index of inflow time series
+   int            tsCursor;      // position in inflow time series
    int            basePat;       // baseline time pattern
    double         cFactor;       // units conversion factor for mass inflow
    double         baseline;      // constant baseline value
@@ -537,12 +547,25 @@ typedef struct
    double     fixedStage;         // fixed outfall stage (ft)
    int        tideCurve;          // index of tidal stage curve
    int        stageSeries;        // index of outfall stage time series
+   int        stageCursor;        // position in outfall stage time series
    int        routeTo;            // subcatchment index routed onto            //(5.1.008)
    double     vRouted;            // flow volume routed (ft3)                  //(5.1.008)
    double*    wRouted;            // pollutant load routed (mass)              //(5.1.008)
 }  TOutfall;
 
 
+//-----------------------------------------
+// INVERSE GEOMETRY TABLE                                                      //(OPENSWMM 5.1.913)
+//-----------------------------------------
+typedef struct
+{
+   int           n;               // number of grid intervals
+   double        ref;             // value that normalizes the table's input
+   double*       x;               // normalized inverse at n+1 grid points
+   char*         exact;           // TRUE if an interval needs the exact inverse
+}  TInvTable;
+
+
 //--------------------
 // STORAGE UNIT OBJECT
 //--------------------
@@ -554,6 +577,7 @@ typedef struct
    double      aExpon;            // exponent of area v. height curve
    int         aCurve;            // index of tabulated area v. height curve
    TExfil*     exfil;             // ptr. to exfiltration object               //(5.1.007)
+   TInvTable*  dOfV;              // table of depth v. volume                  //(OPENSWMM 5.1.913)
    //-----------------------------
    double      hrt;               // hydraulic residence time (sec)
    double      evapLoss;          // evaporation loss (ft3) 
@@ -597,6 +621,11 @@ typedef struct
    double        aBot;            // area of bottom section
    double        sBot;            // slope of bottom section
    double        rBot;            // radius of bottom section
+
+   TInvTable*    aOfS;            // table of area v. section factor           //(OPENSWMM 5.1.913)
+   TInvTable*    yOfA;            // table of depth v. area
+   TInvTable*    yOfS;            // table of depth v. section factor
+   TInvTable*    yCrit;           // table of critical depth v. flow
 }  TXsect;
 
 
@@ -617,9 +646,9 @@ typedef struct
     double       lengthFactor;              // floodplain / channel length 
     //--------------------------------------
     double       roughness;                 // Manning's n
-    double       areaTbl[N_TRANSECT_TBL];   // table of area v. depth
-    double       hradTbl[N_TRANSECT_TBL];   // table of hyd. radius v. depth
-    double       widthTbl[N_TRANSECT_TBL];  // table of top width v. depth
+    double*      areaTbl;                   // table of area v. depth          //(OPENSWMM 5.1.913)
+    double*      hradTbl;                   // table of hyd. radius v. depth
+    double*      widthTbl;                  // table of top width v. depth
     int          nTbl;                      // size of geometry tables
 }   TTransect;
 
@@ -637,9 +666,9 @@ typedef struct
     double       wMax;                      // max. width
     double       sMax;                      // max. section factor
     double       aMax;                      // area at max. section factor
-    double       areaTbl[N_SHAPE_TBL];      // table of area v. depth
-    double       hradTbl[N_SHAPE_TBL];      // table of hyd. radius v. depth
-    double       widthTbl[N_SHAPE_TBL];     // table of top width v. depth
+    double*      areaTbl;                   // table of area v. depth          //(OPENSWMM 5.1.913)
+    double*      hradTbl;                   // table of hyd. radius v. depth
+    double*      widthTbl;                  // table of top width v. depth
 }   TShape;
 
 
@@ -813,6 +842,7 @@ typedef struct
    int           funcType;        // buildup function type code
    double        coeff[3];        // coeffs. of buildup function
    double        maxDays;         // time to reach max. buildup (days)
+   int           tsCursor;        // position in buildup rate time series
 }  TBuildup;
 
 
@@ -945,6 +975,7 @@ typedef struct
    double        avgTimeStep;
    double        avgStepCount;
    double        steadyStateCount;
+   double        trialCount[MAXTRIALBINS]; // # steps taking 1, 2, ... trials //(OPENSWMM 5.1.913)
 }  TSysStats;
 
 
@@ -401,12 +401,13 @@ void project_freeMatrix(double **a)
 
 //=============================================================================
 
-int project_readOption(char* s1, char* s2)
+int project_readOption(char* s1, char* s2, char* s3)                           //(OPENSWMM 5.1.913)
 //
 //  Input:   s1 = option keyword
 //           s2 = string representation of option's value
+//           s3 = string representation of option's second value ("" if none)
 //  Output:  returns error code
-//  Purpose: reads a project option from a pair of string tokens.
+//  Purpose: reads a project option from a set of string tokens.
 //
 //  NOTE:    all project options have default values assigned in setDefaults().
 //
@@ -560,6 +561,9 @@ int project_readOption(char* s1, char* s2)
       case IGNORE_QUALITY:
 	  case WATER_AGE:					 //(OPENSWMM 5.1.912)
       case IGNORE_RDII:                                                        //(5.1.004)
+      case SOLVER_PREDICTOR:                                                   //(OPENSWMM 5.1.913)
+      case CHECK_GEOM_TABLES:                                                  //(OPENSWMM 5.1.913)
+      case FRICTION_TABLE:                                                     //(OPENSWMM 5.1.913)
         m = findmatch(s2, NoYesWords);
         if ( m < 0 ) return error_setInpError(ERR_KEYWORD, s2);
         switch ( k )
@@ -574,6 +578,9 @@ int project_readOption(char* s1, char* s2)
           case IGNORE_QUALITY:    IgnoreQuality   = m;  break;
           case IGNORE_RDII:       IgnoreRDII      = m;  break;                 //(5.1.004)
 		  case WATER_AGE:		  ModelWaterAge = m; break;		 //(OPENSWMM 5.1.912)
+          case SOLVER_PREDICTOR:  SolverPredictor = m;  break;                 //(OPENSWMM 5.1.913)
+          case CHECK_GEOM_TABLES: CheckGeomTables = m;  break;                 //(OPENSWMM 5.1.913)
+          case FRICTION_TABLE:    FricFactorTable = m;  break;                 //(OPENSWMM 5.1.913)
         }
         break;
 
@@ -590,6 +597,35 @@ int project_readOption(char* s1, char* s2)
         ForceMainEqn = m;
         break;
 
+      // --- method used to solve for node heads under dynamic wave routing
+      case SOLVER_METHOD:                                                      //(OPENSWMM 5.1.913)
+        m = findmatch(s2, SolverMethodWords);
+        if ( m < 0 ) return error_setInpError(ERR_KEYWORD, s2);
+        SolverMethod = m;
+        break;
+
+      // --- number of power-of-two time step classes used by multirate
+      //     dynamic wave routing (0 = all objects share one time step)
+      case MULTIRATE_CLASSES:                                                  //(OPENSWMM 5.1.913)
+        m = atoi(s2);
+        if ( m < 0 || m > MAXCLASSES ) return error_setInpError(ERR_NUMBER, s2);
+        MultirateClasses = m;
+        break;
+
+      // --- acceleration of dynamic wave iterations (with optional number
+      //     of past iterations used by Anderson acceleration)
+      case SOLVER_ACCEL:                                                       //(OPENSWMM 5.1.913)
+        m = findmatch(s2, SolverAccelWords);
+        if ( m < 0 ) return error_setInpError(ERR_KEYWORD, s2);
+        SolverAccel = m;
+        if ( m == ANDERSON && strlen(s3) > 0 )
+        {
+            if ( !getInt(s3, &h) || h < 1 || h > MAXACCEL )
+                return error_setInpError(ERR_NUMBER, s3);
+            AccelTerms = h;
+        }
+        break;
+
       case LINK_OFFSETS:
         m = findmatch(s2, LinkOffsetWords);
         if ( m < 0 ) return error_setInpError(ERR_KEYWORD, s2);
@@ -697,6 +733,26 @@ int project_readOption(char* s1, char* s2)
         SysFlowTol /= 100.0;
         break;
 
+      // --- tolerance (as a fraction of full values) of the inverse
+      //     geometry tables used in place of exact solutions
+      //     (a value of 0 means that no tables are used)
+      case GEOMETRY_TOL:                                                       //(OPENSWMM 5.1.913)
+        if ( !getDouble(s2, &GeometryTol) || GeometryTol < 0.0 )
+        {
+            return error_setInpError(ERR_NUMBER, s2);
+        }
+        break;
+
+      // --- tolerance (as a fraction of full depth) of the depth v. volume
+      //     tables used for functional storage curves
+      //     (a value of 0 means that no tables are used)
+      case STORAGE_TOL:                                                        //(OPENSWMM 5.1.913)
+        if ( !getDouble(s2, &StorageTol) || StorageTol < 0.0 )
+        {
+            return error_setInpError(ERR_NUMBER, s2);
+        }
+        break;
+
       // --- steady state tolerance on nodal lateral inflow
       case LAT_FLOW_TOL:
         if ( !getDouble(s2, &LatFlowTol) )
@@ -815,8 +871,17 @@ void setDefaults()
    MaxTrials       = 0;                // Force use of default max. trials 
    HeadTol         = 0.0;              // Force use of default head tolerance
    SysFlowTol      = 0.05;             // System flow tolerance for steady state
+   GeometryTol     = 0.0;              // No inverse geometry tables           //(OPENSWMM 5.1.913)
+   CheckGeomTables = FALSE;            // Don't check geometry tables          //(OPENSWMM 5.1.913)
+   StorageTol      = 0.0;              // No storage depth tables              //(OPENSWMM 5.1.913)
+   FricFactorTable = FALSE;            // Exact force main friction factors    //(OPENSWMM 5.1.913)
    LatFlowTol      = 0.05;             // Lateral flow tolerance for steady state
    NumThreads      = 0;                // Number of parallel threads to use
+   SolverMethod    = PICARD;           // Picard iterations for DW routing     //(OPENSWMM 5.1.913)
+   MultirateClasses = 0;               // Single time step for DW routing      //(OPENSWMM 5.1.913)
+   SolverAccel     = NO_ACCEL;         // No acceleration of DW iterations     //(OPENSWMM 5.1.913)
+   AccelTerms      = 3;                // Past iterations used by Anderson     //(OPENSWMM 5.1.913)
+   SolverPredictor = FALSE;            // Start DW iterations from last state  //(OPENSWMM 5.1.913)
    NumEvents       = 0;                // Number of detailed routing events    //(5.1.011)
 
    // Deprecated options
@@ -847,6 +912,7 @@ void setDefaults()
    // Temperature data
    Temp.dataSource  = NO_TEMP;
    Temp.tSeries     = -1;
+   Temp.tsCursor    = 0;
    Temp.ta          = 70.0;
    Temp.elev        = 0.0;
    Temp.anglat      = 40.0;
@@ -1090,6 +1156,7 @@ void createObjects()
 
     // --- initialize storage node exfiltration                                //(5.1.007)
     for (j = 0; j < Nnodes[STORAGE]; j++) Storage[j].exfil = NULL;             //(5.1.007)
+    for (j = 0; j < Nnodes[STORAGE]; j++) Storage[j].dOfV = NULL;              //(OPENSWMM 5.1.913)
 
     // --- initialize link properties
     for (j = 0; j < Nobjects[LINK]; j++)
@@ -1183,6 +1250,12 @@ void deleteObjects()
             FREE(Storage[j].exfil->bankExfil);
             FREE(Storage[j].exfil);
         }
+        if ( Storage[j].dOfV )                                                 //(OPENSWMM 5.1.913)
+        {
+            FREE(Storage[j].dOfV->x);
+            FREE(Storage[j].dOfV->exact);
+            FREE(Storage[j].dOfV);
+        }
     }
 ////
 
@@ -1207,6 +1280,7 @@ void deleteObjects()
 
     // --- delete cross section transects
     transect_delete();
+    xsect_deleteSharedTables();                                                //(OPENSWMM 5.1.913)
 
     // --- delete control rules
     controls_delete();
@@ -65,6 +65,7 @@ extern REAL4* SubcatchResults;         // Results vectors defined in OUTPUT.C
 extern REAL4* NodeResults;             //  "
 extern REAL4* LinkResults;             //  "
 extern char   ErrString[81];           // defined in ERROR.C
+#pragma omp threadprivate(ErrString)                                           //(OPENSWMM 5.1.913)
 
 //-----------------------------------------------------------------------------
 //  Local functions
@@ -256,6 +257,7 @@ void report_writeOptions()
 //
 {
     char str[80];
+    double yCritErr, yNormErr;                                                 //(OPENSWMM 5.1.913)
     WRITE("");
     WRITE("*********************************************************");
     WRITE("NOTE: The summary statistics displayed in this report are");
@@ -329,6 +331,19 @@ void report_writeOptions()
     if ( Nobjects[LINK] > 0 )
     {
         fprintf(Frpt.file, "\n  Routing Time Step ........ %.2f sec", RouteStep);
+        if ( GeometryTol > 0.0 )                                               //(OPENSWMM 5.1.913)
+        fprintf(Frpt.file, "\n  Geometry Table Tolerance . %.6f", GeometryTol);
+        if ( GeometryTol > 0.0 && CheckGeomTables )                            //(OPENSWMM 5.1.913)
+        {
+            xsect_getTableErrors(&yCritErr, &yNormErr);
+            fprintf(Frpt.file, "\n  Critical Depth Table Error %.6f", yCritErr);
+            fprintf(Frpt.file, "\n  Normal Depth Table Error . %.6f", yNormErr);
+        }
+        if ( StorageTol > 0.0 && Nnodes[STORAGE] > 0 )                         //(OPENSWMM 5.1.913)
+        fprintf(Frpt.file, "\n  Storage Table Tolerance .. %.6f", StorageTol);
+        if ( FricFactorTable && forcemain_getFricTableError() > 0.0 )          //(OPENSWMM 5.1.913)
+        fprintf(Frpt.file, "\n  Friction Table Error ..... %.6f",
+            forcemain_getFricTableError());
 		if ( RouteModel == DW )
 		{
 		fprintf(Frpt.file, "\n  Variable Time Step ....... ");
@@ -336,6 +351,17 @@ void report_writeOptions()
 		else                       fprintf(Frpt.file, "NO");
 		fprintf(Frpt.file, "\n  Maximum Trials ........... %d", MaxTrials);
         fprintf(Frpt.file, "\n  Number of Threads ........ %d", NumThreads);   //(5.1.008)
+        if ( SolverMethod != PICARD )                                          //(OPENSWMM 5.1.913)
+        fprintf(Frpt.file, "\n  Solver Method ............ %s",
+            SolverMethodWords[SolverMethod]);
+        if ( MultirateClasses > 0 )                                            //(OPENSWMM 5.1.913)
+        fprintf(Frpt.file, "\n  Multirate Classes ........ %d",
+            MultirateClasses);
+        if ( SolverAccel == ANDERSON )                                         //(OPENSWMM 5.1.913)
+        fprintf(Frpt.file, "\n  Solver Acceleration ...... %s (%d terms)",
+            SolverAccelWords[SolverAccel], AccelTerms);
+        if ( SolverPredictor )                                                 //(OPENSWMM 5.1.913)
+        fprintf(Frpt.file, "\n  Solver Predictor ......... YES");
 		fprintf(Frpt.file, "\n  Head Tolerance ........... %.6f ",
             HeadTol*UCF(LENGTH));                                              //(5.1.008)
 		if ( UnitSystem == US ) fprintf(Frpt.file, "ft");
@@ -1011,6 +1037,7 @@ void report_writeSysStats(TSysStats* sysStats)
 //  Purpose: writes simulation statistics for overall system to report file.
 //
 {
+    int    k;                                                                  //(OPENSWMM 5.1.913)
     double x;
     double eventStepCount = (double)StepCount - sysStats->steadyStateCount;    //(5.1.012)
 
@@ -1038,6 +1065,21 @@ void report_writeSysStats(TSysStats* sysStats)
     fprintf(Frpt.file,
         "\n  Percent Not Converging      :  %7.2f",
         100.0 * (double)NonConvergeCount / eventStepCount);                    //(5.1.012)
+
+    // --- distribution of trials per step for dynamic wave routing            //(OPENSWMM 5.1.913)
+    if ( RouteModel == DW )
+    {
+        for (k = 0; k < MAXTRIALBINS; k++)
+        {
+            if ( sysStats->trialCount[k] == 0.0 ) continue;
+            if ( k < MAXTRIALBINS - 1 ) fprintf(Frpt.file,
+                "\n  Percent with %d Trials       :  %7.2f", k + 1,
+                100.0 * sysStats->trialCount[k] / eventStepCount);
+            else fprintf(Frpt.file,
+                "\n  Percent with %d+ Trials      :  %7.2f", k + 1,
+                100.0 * sysStats->trialCount[k] / eventStepCount);
+        }
+    }
     WRITE("");
 }
 
@@ -7,6 +7,10 @@
 //   Author:   L. Rossman
 //
 //   Geometry functions for custom cross-section shapes.
+//
+//   OpenSWMM 5.1.913:
+//   - Geometry tables are built in a scratch array and then replaced by a
+//     copy shared by all shapes with identical tables.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -18,6 +22,8 @@
 //-----------------------------------------------------------------------------
 static double Atotal;
 static double Ptotal;
+static double Tables[3*N_SHAPE_TBL];       // scratch geometry tables          //(OPENSWMM 5.1.913)
+static double EmptyTables[3*N_SHAPE_TBL];  // tables of invalid shapes
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
@@ -36,6 +42,7 @@ static int    getNextInterval(TTable *curve, double y, double yLast,
 static double getWidth(double y, double y1, double y2, double w1, double w2);
 static double getArea(double y, double w, double y1, double w1);
 static double getPerim(double y, double w, double y1, double w1);
+static void   setTables(TShape *shape, double *tables);                        //(OPENSWMM 5.1.913)
 
 //=============================================================================
 
@@ -48,8 +55,25 @@ int  shape_validate(TShape *shape, TTable *curve)
 //           tables from its user-supplied width v. height curve.
 //
 {
-    if ( !computeShapeTables(shape, curve) ) return FALSE;
-    if ( !normalizeShapeTables(shape) ) return FALSE;
+    double* tables;                                                            //(OPENSWMM 5.1.913)
+
+    // --- build tables in scratch space
+    setTables(shape, Tables);
+    if ( !computeShapeTables(shape, curve) ||
+         !normalizeShapeTables(shape) )
+    {
+        setTables(shape, EmptyTables);
+        return FALSE;
+    }
+
+    // --- replace scratch tables with a shared copy
+    tables = xsect_shareTables(Tables, 3*N_SHAPE_TBL);
+    if ( tables == NULL )
+    {
+        setTables(shape, EmptyTables);
+        return FALSE;
+    }
+    setTables(shape, tables);
     return TRUE;
 }
 
@@ -328,3 +352,21 @@ double getPerim(double y, double w, double y1, double w1)
     double dw = fabs(w - w1) / 2.0;
     return 2.0 * sqrt(dy*dy + dw*dw);
 }
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+void setTables(TShape *shape, double *tables)
+//
+//  Input:   shape = pointer to a TShape object
+//           tables = array holding the three geometry tables
+//  Output:  none
+//  Purpose: points a shape's geometry tables at consecutive sections of
+//           an array.
+//
+{
+    shape->areaTbl = tables;
+    shape->hradTbl = tables + N_SHAPE_TBL;
+    shape->widthTbl = tables + 2*N_SHAPE_TBL;
+}
@@ -0,0 +1,337 @@
+//-----------------------------------------------------------------------------
+//   smatrix.c
+//
+//   Sparse solver for a symmetric positive definite system of linear
+//   equations whose non-zero pattern is defined by the edges of a network.
+//
+//   The rows of the matrix are re-ordered with the Reverse Cuthill-McKee
+//   algorithm to reduce their envelope (or profile), and the matrix is
+//   then factored in place within that envelope using Cholesky's method.
+//   Because fill-in can only occur inside the envelope, the storage
+//   needed for the factorization is fixed when the solver is opened.
+//
+//   Date:     10/16/26
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <math.h>
+#include "smatrix.h"
+
+//-----------------------------------------------------------------------------
+//    Local declarations
+//-----------------------------------------------------------------------------
+static int     Nrows;     // number of rows (equations)
+static int*    Perm;      // Perm[k] = original row placed in position k
+static int*    Iperm;     // Iperm[i] = position of original row i
+static int*    First;     // first column of envelope in each permuted row
+static long*   Start;     // start of each permuted row's entries in Env
+static double* Env;       // off-diagonal envelope of lower triangle
+static double* Diag;      // diagonal entries
+static double* Work;      // work array for forward/back substitution
+
+// adjacency lists used to build the row ordering
+static int*    AdjStart;  // start of each row's adjacency list
+static int*    AdjList;   // adjacent rows
+static int*    Degree;    // number of adjacent rows
+
+static int  buildAdjacency(int nEdges, int row1[], int row2[]);
+static void orderRows(void);
+static int  visitComponent(int root, int k, char* marked);
+static void buildEnvelope(void);
+
+
+//-----------------------------------------------------------------------------
+//    open the solver for a system of n equations whose off-diagonal
+//    coefficients lie at the positions (row1[k], row2[k]) of each of
+//    nEdges network edges; negative row indexes are ignored
+//    (returns 1 if successful, 0 if not)
+//-----------------------------------------------------------------------------
+int smatrix_open(int n, int nEdges, int row1[], int row2[])
+{
+    smatrix_close();
+    Nrows = n;
+    if ( n <= 0 ) return 1;
+    Perm   = (int *) calloc(n, sizeof(int));
+    Iperm  = (int *) calloc(n, sizeof(int));
+    First  = (int *) calloc(n, sizeof(int));
+    Start  = (long *) calloc(n+1, sizeof(long));
+    Diag   = (double *) calloc(n, sizeof(double));
+    Work   = (double *) calloc(n, sizeof(double));
+    Degree = (int *) calloc(n, sizeof(int));
+    AdjStart = (int *) calloc(n+1, sizeof(int));
+    if ( !Perm || !Iperm || !First || !Start || !Diag || !Work ||
+         !Degree || !AdjStart ) return 0;
+    if ( !buildAdjacency(nEdges, row1, row2) ) return 0;
+    orderRows();
+    buildEnvelope();
+
+    // --- adjacency lists are no longer needed
+    free(AdjList);
+    AdjList = NULL;
+    free(AdjStart);
+    AdjStart = NULL;
+    free(Degree);
+    Degree = NULL;
+    Env = (double *) calloc(Start[n] > 0 ? Start[n] : 1, sizeof(double));
+    if ( !Env ) return 0;
+    return 1;
+}
+
+
+//-----------------------------------------------------------------------------
+//    close the solver
+//-----------------------------------------------------------------------------
+void smatrix_close()
+{
+    if ( Perm ) free(Perm);
+    Perm = NULL;
+    if ( Iperm ) free(Iperm);
+    Iperm = NULL;
+    if ( First ) free(First);
+    First = NULL;
+    if ( Start ) free(Start);
+    Start = NULL;
+    if ( Env ) free(Env);
+    Env = NULL;
+    if ( Diag ) free(Diag);
+    Diag = NULL;
+    if ( Work ) free(Work);
+    Work = NULL;
+    if ( AdjStart ) free(AdjStart);
+    AdjStart = NULL;
+    if ( AdjList ) free(AdjList);
+    AdjList = NULL;
+    if ( Degree ) free(Degree);
+    Degree = NULL;
+    Nrows = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+//    set all coefficients of the matrix to zero
+//-----------------------------------------------------------------------------
+void smatrix_clear()
+{
+    long k;
+    int  i;
+    if ( Nrows <= 0 ) return;
+    for (i = 0; i < Nrows; i++) Diag[i] = 0.0;
+    for (k = 0; k < Start[Nrows]; k++) Env[k] = 0.0;
+}
+
+
+//-----------------------------------------------------------------------------
+//    add a to the diagonal coefficient of row i
+//-----------------------------------------------------------------------------
+void smatrix_addDiag(int i, double a)
+{
+    if ( i < 0 || i >= Nrows ) return;
+    Diag[Iperm[i]] += a;
+}
+
+
+//-----------------------------------------------------------------------------
+//    add a to the symmetric pair of coefficients in row i, column j
+//    (the pair must be one of the edges the solver was opened with)
+//-----------------------------------------------------------------------------
+void smatrix_addOffDiag(int i, int j, double a)
+{
+    int p, q, t;
+    if ( i < 0 || j < 0 || i == j ) return;
+    p = Iperm[i];
+    q = Iperm[j];
+    if ( p < q )
+    {
+        t = p;
+        p = q;
+        q = t;
+    }
+    if ( q < First[p] ) return;
+    Env[Start[p] + q - First[p]] += a;
+}
+
+
+//-----------------------------------------------------------------------------
+//    factor the matrix and solve for x given right hand side b
+//    (returns 1 if successful or 0 if matrix is not positive definite;
+//     the matrix is overwritten by its factorization)
+//-----------------------------------------------------------------------------
+int smatrix_solve(double b[], double x[])
+{
+    int     j, k, l, m;
+    double  s;
+    double* rowk;
+    double* rowj;
+
+    // --- Cholesky factorization within the envelope
+    for (k = 0; k < Nrows; k++)
+    {
+        rowk = Env + Start[k] - First[k];
+        for (j = First[k]; j < k; j++)
+        {
+            rowj = Env + Start[j] - First[j];
+            m = First[k] > First[j] ? First[k] : First[j];
+            s = rowk[j];
+            for (l = m; l < j; l++) s -= rowk[l] * rowj[l];
+            rowk[j] = s / Diag[j];
+        }
+        s = Diag[k];
+        for (l = First[k]; l < k; l++) s -= rowk[l] * rowk[l];
+        if ( s <= 0.0 ) return 0;
+        Diag[k] = sqrt(s);
+    }
+
+    // --- forward substitution
+    for (k = 0; k < Nrows; k++)
+    {
+        rowk = Env + Start[k] - First[k];
+        s = b[Perm[k]];
+        for (l = First[k]; l < k; l++) s -= rowk[l] * Work[l];
+        Work[k] = s / Diag[k];
+    }
+
+    // --- back substitution
+    for (k = Nrows - 1; k >= 0; k--)
+    {
+        rowk = Env + Start[k] - First[k];
+        Work[k] /= Diag[k];
+        for (l = First[k]; l < k; l++) Work[l] -= rowk[l] * Work[k];
+        x[Perm[k]] = Work[k];
+    }
+    return 1;
+}
+
+
+//-----------------------------------------------------------------------------
+//    build the lists of rows adjacent to each row
+//-----------------------------------------------------------------------------
+int buildAdjacency(int nEdges, int row1[], int row2[])
+{
+    int i, j, k;
+
+    for (k = 0; k < nEdges; k++)
+    {
+        i = row1[k];
+        j = row2[k];
+        if ( i < 0 || j < 0 || i == j ) continue;
+        Degree[i]++;
+        Degree[j]++;
+    }
+    for (i = 0; i < Nrows; i++) AdjStart[i+1] = AdjStart[i] + Degree[i];
+    AdjList = (int *) calloc(AdjStart[Nrows] > 0 ? AdjStart[Nrows] : 1,
+                             sizeof(int));
+    if ( !AdjList ) return 0;
+    for (i = 0; i < Nrows; i++) Degree[i] = 0;
+    for (k = 0; k < nEdges; k++)
+    {
+        i = row1[k];
+        j = row2[k];
+        if ( i < 0 || j < 0 || i == j ) continue;
+        AdjList[AdjStart[i] + Degree[i]++] = j;
+        AdjList[AdjStart[j] + Degree[j]++] = i;
+    }
+    return 1;
+}
+
+
+//-----------------------------------------------------------------------------
+//    find a Reverse Cuthill-McKee ordering of the rows
+//-----------------------------------------------------------------------------
+void orderRows()
+{
+    int   i, k, t, root, last;
+    char* marked = (char *) calloc(Nrows, sizeof(char));
+
+    // --- if memory is short, keep the original ordering
+    if ( marked == NULL )
+    {
+        for (i = 0; i < Nrows; i++) Perm[i] = i;
+    }
+
+    // --- order each connected group of rows in turn
+    else
+    {
+        k = 0;
+        for (i = 0; i < Nrows; i++)
+        {
+            if ( marked[i] ) continue;
+
+            // --- a trial ordering from row i ends on a row lying far
+            //     from it, which then serves as the component's root
+            last = visitComponent(i, k, marked);
+            root = Perm[last-1];
+            for (t = k; t < last; t++) marked[Perm[t]] = 0;
+            k = visitComponent(root, k, marked);
+        }
+        free(marked);
+
+        // --- reverse the ordering
+        for (i = 0; i < Nrows / 2; i++)
+        {
+            t = Perm[i];
+            Perm[i] = Perm[Nrows-1-i];
+            Perm[Nrows-1-i] = t;
+        }
+    }
+    for (i = 0; i < Nrows; i++) Iperm[Perm[i]] = i;
+}
+
+
+//-----------------------------------------------------------------------------
+//    add the rows connected to root to the ordering in breadth-first
+//    order, starting at position k, with adjacent rows visited in order
+//    of increasing degree (returns next free position in the ordering)
+//-----------------------------------------------------------------------------
+int visitComponent(int root, int k, char* marked)
+{
+    int i, j, m, n, n0, head, tail;
+
+    head = k;
+    tail = k;
+    Perm[tail++] = root;
+    marked[root] = 1;
+    while ( head < tail )
+    {
+        i = Perm[head++];
+        n0 = tail;
+        for (m = AdjStart[i]; m < AdjStart[i+1]; m++)
+        {
+            j = AdjList[m];
+            if ( marked[j] ) continue;
+            marked[j] = 1;
+
+            // --- insertion sort of newly reached rows by degree
+            n = tail;
+            while ( n > n0 && Degree[Perm[n-1]] > Degree[j] )
+            {
+                Perm[n] = Perm[n-1];
+                n--;
+            }
+            Perm[n] = j;
+            tail++;
+        }
+    }
+    return tail;
+}
+
+
+//-----------------------------------------------------------------------------
+//    find the envelope of the re-ordered matrix
+//-----------------------------------------------------------------------------
+void buildEnvelope()
+{
+    int i, k, m, p;
+
+    for (k = 0; k < Nrows; k++) First[k] = k;
+    for (k = 0; k < Nrows; k++)
+    {
+        i = Perm[k];
+        for (m = AdjStart[i]; m < AdjStart[i+1]; m++)
+        {
+            p = Iperm[AdjList[m]];
+            if ( p < First[k] ) First[k] = p;
+        }
+    }
+    Start[0] = 0;
+    for (k = 0; k < Nrows; k++) Start[k+1] = Start[k] + (k - First[k]);
+}
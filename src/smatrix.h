@@ -0,0 +1,15 @@
+//-----------------------------------------------------------------------------
+//  smatrix.h
+//
+//  Header file for the sparse symmetric linear equation solver contained
+//  in smatrix.c
+//
+//-----------------------------------------------------------------------------
+
+// functions that open, close, and use the sparse matrix solver
+int  smatrix_open(int n, int nEdges, int row1[], int row2[]);
+void smatrix_close(void);
+void smatrix_clear(void);
+void smatrix_addDiag(int i, double a);
+void smatrix_addOffDiag(int i, int j, double a);
+int  smatrix_solve(double b[], double x[]);
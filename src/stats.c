@@ -278,6 +278,7 @@ int  stats_open()
     SysStats.avgTimeStep = 0.0;
     SysStats.avgStepCount = 0.0;
     SysStats.steadyStateCount = 0.0;
+    for (j = 0; j < MAXTRIALBINS; j++) SysStats.trialCount[j] = 0.0;          //(OPENSWMM 5.1.913)
     return 0;
 }
 
@@ -454,6 +455,8 @@ void   stats_updateFlowStats(double tStep, DateTime aDate, int stepCount,
 
         // --- update iteration step count stats
         SysStats.avgStepCount += stepCount;
+        if ( stepCount > 0 )                                                   //(OPENSWMM 5.1.913)
+            SysStats.trialCount[MIN(stepCount, MAXTRIALBINS) - 1] += 1.0;
 	}
 
 ////
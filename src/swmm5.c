@@ -701,6 +701,52 @@ int DLLEXPORT swmm_getWarnings(void)
 
 //=============================================================================
 
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int DLLEXPORT swmm_convertTimeseries(char* f1, char* f2)
+//
+//  Input:   f1 = name of a time series data file
+//           f2 = name of the binary time series file to create
+//  Output:  returns an error code
+//  Purpose: converts a time series data file into the binary format that
+//           SWMM reads through a memory mapping.
+//
+{
+    // --- dates in time series files are read as they are in an input file
+    datetime_setDateFormat(M_D_Y);
+    return error_getCode(table_convertFile(f1, f2));
+}
+
+//=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+int DLLEXPORT swmm_compile(char* f1, char* f2, char* f3)
+//
+//  Input:   f1 = name of input file
+//           f2 = name of report file
+//           f3 = name of compiled input file to create
+//  Output:  returns an error code
+//  Purpose: checks a project's input data and saves it to a compiled input
+//           file that can be opened in place of the input file.
+//
+{
+    int errcode;
+
+    // --- open the project, saving its tokenized lines of input to f3
+    input_setCompiledFile(f3);
+    errcode = swmm_open(f1, f2, f3);
+    input_setCompiledFile(NULL);
+
+    // --- don't keep the compiled file if the project's data are not valid
+    //     (IsOpenFlag is set once the project's files are known to differ)
+    if ( errcode && IsOpenFlag ) remove(f3);
+    swmm_close();
+    return errcode;
+}
+
+//=============================================================================
+
 ////  New function added to release 5.1.011.  ////                             //(5.1.011)
 
 int  DLLEXPORT swmm_getError(char* errMsg, int msgLen)
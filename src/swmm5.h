@@ -49,6 +49,8 @@ int  DLLEXPORT   swmm_close(void);
 int  DLLEXPORT   swmm_getVersion(void);
 int  DLLEXPORT   swmm_getError(char* errMsg, int msgLen);                      //(5.1.011)
 int  DLLEXPORT   swmm_getWarnings(void);                                       //(5.1.011)
+int  DLLEXPORT   swmm_convertTimeseries(char* f1, char* f2);                   //(OPENSWMM 5.1.913)
+int  DLLEXPORT   swmm_compile(char* f1, char* f2, char* f3);                   //(OPENSWMM 5.1.913)
 
 #ifdef __cplusplus 
 }   // matches the linkage specification from above */ 
@@ -22,20 +22,68 @@
 //     table_getArea, and table_getInverseArea) were made thread-safe (thanks to
 //     suggestions by CHI).
 //
+//   OpenSWMM 5.1.913:
+//   - Once a table is validated its points are also held in contiguous x/y
+//     arrays that the Curve lookup functions search by bisection, or by
+//     direct indexing when the x-values are evenly spaced.
+//   - Storage curves also hold the area under the curve up to each point,
+//     so table_getArea and table_getInverseArea no longer integrate the
+//     curve from its first entry on each call.
+//   - table_tseriesLookupAt lets each user of an in-memory time series keep
+//     its own position in it, and can move to any date in either direction
+//     by searching the series' point arrays.
+//   - An external time series file can be in a binary format (written by
+//     table_convertFile) that is memory-mapped and searched in place rather
+//     than parsed line by line.
+//
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
+#ifdef _WIN32                                                                  //(OPENSWMM 5.1.913)
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
 #include "headers.h"
 
+//-----------------------------------------------------------------------------
+//  Binary time series files                                                   //(OPENSWMM 5.1.913)
+//-----------------------------------------------------------------------------
+//  A binary time series file holds a TTsbHeader followed by the dates (as
+//  decimal days) of all of its points and then their values, each stored
+//  as native doubles.
+static const char TsbMagic[8] = {'S','W','M','M','5','T','S','B'};
+enum  TsbVersion {TSB_VERSION = 1};
+
+typedef struct
+{
+    char   magic[8];                   // identifies a binary time series file
+    int    version;                    // file format version
+    int    nPoints;                    // number of data points
+    double dxMin;                      // smallest time interval (days)
+    double dxGrid;                     // time interval if uniform (else 0)
+}  TTsbHeader;
+
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
 int    table_getNextFileEntry(TTable* table, double* x, double* y);
 int    table_parseFileLine(char* line, TTable* table, double* x, double* y);
 double table_interpolate(double x, double x1, double y1, double x2, double y2);//(5.1.008)
+int    table_createPoints(TTable* table);                                      //(OPENSWMM 5.1.913)
+void   table_freePoints(TTable* table);
+int    table_findPoint(TTable* table, double x);
+void   table_createAreas(TTable* table);
+double table_getGridSpacing(double x[], int n);
+int    table_isBinaryFile(char* fname);
+int    table_mapFile(TTable* table);
+void   table_unmapFile(TTable* table);
 
 
 //=============================================================================
@@ -206,6 +254,7 @@ int table_addEntry(TTable* table, double x, double y)
     TTableEntry *entry;
     entry = (TTableEntry *) malloc(sizeof(TTableEntry));
     if ( !entry ) return FALSE;
+    table_freePoints(table);                                                   //(OPENSWMM 5.1.913)
     entry->x = x;
     entry->y = y;
     entry->next = NULL;
@@ -236,6 +285,7 @@ void   table_deleteEntries(TTable *table)
     table->firstEntry = NULL;
     table->lastEntry  = NULL;
     table->thisEntry  = NULL;
+    table_freePoints(table);                                                   //(OPENSWMM 5.1.913)
 
     if (table->file.file)
     { 
@@ -267,6 +317,14 @@ void   table_init(TTable *table)
     table->file.mode = NO_FILE;
     table->file.file = NULL;
     table->curveType = -1;
+    table->nPoints = 0;                                                        //(OPENSWMM 5.1.913)
+    table->xPoints = NULL;
+    table->yPoints = NULL;
+    table->aPoints = NULL;
+    table->dxGrid = 0.0;
+    table->yFalls = 0;
+    table->fileMap = NULL;
+    table->thisPoint = 0;
 }
 
 //=============================================================================
@@ -283,8 +341,11 @@ int   table_validate(TTable *table)
     double dx, dxMin = BIG;
 
     // --- open external file if used as the table's data source
+    //     (a binary file is mapped into memory instead)                      //(OPENSWMM 5.1.913)
     if ( table->file.mode == USE_FILE )
     {
+        if ( table_isBinaryFile(table->file.name) )
+            return table_mapFile(table);
         table->file.file = fopen(table->file.name, "rt");
         if ( table->file.file == NULL ) return ERR_TABLE_FILE_OPEN;
     }
@@ -312,11 +373,376 @@ int   table_validate(TTable *table)
     // --- return error if external file could not be read completely
     if ( table->file.mode == USE_FILE && !feof(table->file.file) )
         return ERR_TABLE_FILE_READ;
+
+    // --- place the points of an in-memory table in arrays for searching
+    //     (if memory runs out the table's entry list is searched instead)
+    if ( table->file.mode != USE_FILE ) table_createPoints(table);             //(OPENSWMM 5.1.913)
     return 0;
 }
 
 //=============================================================================
 
+////  New functions added to release 5.1.913.  ////                            //(OPENSWMM 5.1.913)
+
+int table_createPoints(TTable *table)
+//
+//  Input:   table = pointer to a validated TTable structure
+//  Output:  returns TRUE if successful, FALSE if out of memory
+//  Purpose: copies a table's entries into contiguous x/y arrays and notes
+//           whether its x-values are evenly spaced.
+//
+{
+    int    n = 0, k;
+    TTableEntry* entry;
+
+    table_freePoints(table);
+    for ( entry = table->firstEntry; entry; entry = entry->next ) n++;
+    if ( n == 0 ) return TRUE;
+    table->xPoints = (double *) malloc(n * sizeof(double));
+    table->yPoints = (double *) malloc(n * sizeof(double));
+    if ( !table->xPoints || !table->yPoints )
+    {
+        table_freePoints(table);
+        return FALSE;
+    }
+    k = 0;
+    for ( entry = table->firstEntry; entry; entry = entry->next )
+    {
+        table->xPoints[k] = entry->x;
+        table->yPoints[k] = entry->y;
+        k++;
+    }
+
+    table->dxGrid = table_getGridSpacing(table->xPoints, n);
+
+    // --- find the first point where the y-values start to fall
+    for ( k = 1; k < n; k++ )
+    {
+        if ( table->yPoints[k] < table->yPoints[k-1] ) break;
+    }
+    table->yFalls = k;
+    table->nPoints = n;
+
+    // --- storage curves also get the cumulative area at each point
+    if ( table->curveType == STORAGE_CURVE ) table_createAreas(table);
+    return TRUE;
+}
+
+//=============================================================================
+
+void table_createAreas(TTable *table)
+//
+//  Input:   table = pointer to a TTable structure with x/y arrays
+//  Output:  none
+//  Purpose: finds the area under a table's curve from 0 up to each of its
+//           points (see table_getArea).
+//
+//  NOTE: the areas are accumulated in the same order as table_getArea
+//        does when it walks the table's entry list. They are not created
+//        if any y-value is negative, since they must be non-decreasing to
+//        be searched by bisection.
+//
+{
+    int    n = table->nPoints, k;
+    double* xp = table->xPoints;
+    double* yp = table->yPoints;
+
+    for ( k = 0; k < n; k++ ) if ( yp[k] < 0.0 ) return;
+    table->aPoints = (double *) malloc(n * sizeof(double));
+    if ( !table->aPoints ) return;
+    table->aPoints[0] = yp[0] * xp[0] / 2.0;
+    for ( k = 1; k < n; k++ )
+    {
+        table->aPoints[k] = table->aPoints[k-1] +
+                            (yp[k-1] + yp[k]) * (xp[k] - xp[k-1]) / 2.0;
+    }
+}
+
+//=============================================================================
+
+double table_getGridSpacing(double x[], int n)
+//
+//  Input:   x = array of ascending x-values
+//           n = number of x-values
+//  Output:  returns the spacing between the x-values if they are evenly
+//           spaced or 0 if not
+//  Purpose: checks if a table's x-values lie on a uniform grid.
+//
+//  NOTE: the grid spacing is only a first guess at where a value lies,
+//        so spacing that is uniform to within round-off will do.
+//
+{
+    int    k;
+    double dx;
+
+    if ( n <= 2 ) return 0.0;
+    dx = (x[n-1] - x[0]) / (n - 1);
+    for ( k = 1; k < n; k++ )
+    {
+        if ( fabs(x[k] - x[k-1] - dx) > 1.0e-6 * dx ) return 0.0;
+    }
+    return dx;
+}
+
+//=============================================================================
+
+void table_freePoints(TTable *table)
+//
+//  Input:   table = pointer to a TTable structure
+//  Output:  none
+//  Purpose: frees a table's x/y arrays, so that its linked list of entries
+//           is used until the arrays are created again.
+//
+{
+    if ( table->fileMap )
+    {
+        table_unmapFile(table);
+        table->xPoints = NULL;
+        table->yPoints = NULL;
+    }
+    FREE(table->xPoints);
+    FREE(table->yPoints);
+    FREE(table->aPoints);
+    table->nPoints = 0;
+    table->dxGrid = 0.0;
+    table->yFalls = 0;
+}
+
+//=============================================================================
+
+int table_isBinaryFile(char* fname)
+//
+//  Input:   fname = name of a time series data file
+//  Output:  returns TRUE if the file is a binary time series file
+//  Purpose: checks if a time series file starts with the binary file marker.
+//
+{
+    char  magic[sizeof(TsbMagic)];
+    int   result = FALSE;
+    FILE* f = fopen(fname, "rb");
+
+    if ( f == NULL ) return FALSE;
+    if ( fread(magic, 1, sizeof(magic), f) == sizeof(magic) &&
+         memcmp(magic, TsbMagic, sizeof(magic)) == 0 ) result = TRUE;
+    fclose(f);
+    return result;
+}
+
+//=============================================================================
+
+int table_mapFile(TTable *table)
+//
+//  Input:   table = pointer to a TTable structure that uses a binary file
+//  Output:  returns an error code
+//  Purpose: maps a binary time series file into memory and points the
+//           table's x/y arrays at the data held in it.
+//
+//  NOTE: the file's data were checked for ascending dates when it was
+//        created, so they are not read again here.
+//
+{
+    TTsbHeader* header;
+    void*       base = NULL;
+    double      size = 0.0;
+
+#ifdef _WIN32
+    HANDLE        f, m;
+    LARGE_INTEGER fsize;
+
+    f = CreateFileA(table->file.name, GENERIC_READ, FILE_SHARE_READ, NULL,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if ( f == INVALID_HANDLE_VALUE ) return ERR_TABLE_FILE_OPEN;
+    if ( GetFileSizeEx(f, &fsize) ) size = (double)fsize.QuadPart;
+    m = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+    if ( m )
+    {
+        base = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(m);
+    }
+    CloseHandle(f);
+#else
+    int         f;
+    struct stat fstats;
+
+    f = open(table->file.name, O_RDONLY);
+    if ( f < 0 ) return ERR_TABLE_FILE_OPEN;
+    if ( fstat(f, &fstats) == 0 && fstats.st_size > 0 )
+    {
+        size = (double)fstats.st_size;
+        base = mmap(NULL, (size_t)fstats.st_size, PROT_READ, MAP_SHARED, f, 0);
+        if ( base == MAP_FAILED ) base = NULL;
+    }
+    close(f);
+#endif
+    if ( base == NULL ) return ERR_TABLE_FILE_READ;
+    table->fileMap = base;
+
+    // --- check that the header matches the size of the file
+    header = (TTsbHeader *)base;
+    if ( size < sizeof(TTsbHeader)
+    ||   header->version != TSB_VERSION
+    ||   header->nPoints <= 0
+    ||   size != sizeof(TTsbHeader) +
+                 2.0 * header->nPoints * sizeof(double) )
+    {
+        table_unmapFile(table);
+        return ERR_TABLE_FILE_READ;
+    }
+
+    // --- the date and value arrays follow the header
+    table->nPoints = header->nPoints;
+    table->xPoints = (double *)(header + 1);
+    table->yPoints = table->xPoints + header->nPoints;
+    table->dxMin = header->dxMin;
+    table->dxGrid = header->dxGrid;
+    table->yFalls = header->nPoints;
+    table->thisPoint = 0;
+    return 0;
+}
+
+//=============================================================================
+
+void table_unmapFile(TTable *table)
+//
+//  Input:   table = pointer to a TTable structure
+//  Output:  none
+//  Purpose: releases the memory mapping of a binary time series file.
+//
+{
+    TTsbHeader* header = (TTsbHeader *)table->fileMap;
+
+    if ( header == NULL ) return;
+#ifdef _WIN32
+    UnmapViewOfFile(header);
+#else
+    munmap(header, sizeof(TTsbHeader) +
+                   2 * (size_t)header->nPoints * sizeof(double));
+#endif
+    table->fileMap = NULL;
+}
+
+//=============================================================================
+
+int table_convertFile(char* txtFile, char* binFile)
+//
+//  Input:   txtFile = name of a time series data file
+//           binFile = name of the binary time series file to create
+//  Output:  returns an error code
+//  Purpose: converts a time series data file into a binary file that can
+//           be memory-mapped.
+//
+{
+    int     n = 0, nMax = 0;
+    int     errcode = 0;
+    double  x, y;
+    double* xy;
+    double* xp = NULL;
+    double* yp = NULL;
+    FILE*   f;
+    TTable  table;
+    TTsbHeader header;
+
+    // --- read the file's data into growing date & value arrays
+    table_init(&table);
+    table.file.mode = USE_FILE;
+    table.file.file = fopen(txtFile, "rt");
+    if ( table.file.file == NULL ) return ERR_TABLE_FILE_OPEN;
+    memset(&header, 0, sizeof(header));
+    header.dxMin = BIG;
+    while ( table_getNextFileEntry(&table, &x, &y) )
+    {
+        if ( n > 0 )
+        {
+            if ( x <= xp[n-1] )
+            {
+                errcode = ERR_TABLE_FILE_READ;
+                break;
+            }
+            header.dxMin = MIN(header.dxMin, x - xp[n-1]);
+        }
+        if ( n == nMax )
+        {
+            nMax = MAX(2*nMax, 1024);
+            xy = (double *) realloc(xp, nMax * sizeof(double));
+            if ( xy == NULL ) errcode = ERR_MEMORY;
+            else xp = xy;
+            xy = (double *) realloc(yp, nMax * sizeof(double));
+            if ( xy == NULL ) errcode = ERR_MEMORY;
+            else yp = xy;
+        }
+        if ( errcode ) break;
+        xp[n] = x;
+        yp[n] = y;
+        n++;
+    }
+
+    // --- check that the whole file was read
+    if ( !errcode && (n == 0 || !feof(table.file.file)) )
+        errcode = ERR_TABLE_FILE_READ;
+    fclose(table.file.file);
+
+    // --- write the header followed by the date & value arrays
+    if ( !errcode )
+    {
+        memcpy(header.magic, TsbMagic, sizeof(TsbMagic));
+        header.version = TSB_VERSION;
+        header.nPoints = n;
+        header.dxGrid = table_getGridSpacing(xp, n);
+        f = fopen(binFile, "wb");
+        if ( f == NULL ) errcode = ERR_TABLE_FILE_OPEN;
+        else
+        {
+            if ( fwrite(&header, sizeof(header), 1, f) != 1
+            ||   fwrite(xp, sizeof(double), n, f) != (size_t)n
+            ||   fwrite(yp, sizeof(double), n, f) != (size_t)n )
+                errcode = ERR_TABLE_FILE_OPEN;
+            fclose(f);
+        }
+    }
+    FREE(xp);
+    FREE(yp);
+    return errcode;
+}
+
+//=============================================================================
+
+int table_findPoint(TTable *table, double x)
+//
+//  Input:   table = pointer to a TTable structure with x/y arrays
+//           x = an x-value
+//  Output:  returns the index of the first point after the first one whose
+//           x-value is >= x, or the number of points if there is none
+//  Purpose: locates the table interval that contains x.
+//
+{
+    int    n = table->nPoints;
+    int    lo = 1, hi = n, k;
+    double t;
+    double* xp = table->xPoints;
+
+    // --- evenly spaced points: compute the interval & correct round-off
+    if ( table->dxGrid > 0.0 )
+    {
+        t = (x - xp[0]) / table->dxGrid;
+        if ( t >= n ) return n;
+        k = ( t <= 1.0 ) ? 1 : (int)ceil(t);
+        while ( k > 1 && x <= xp[k-1] ) k--;
+        while ( k < n && x > xp[k] ) k++;
+        return k;
+    }
+
+    // --- otherwise bisect the points
+    while ( lo < hi )
+    {
+        k = (lo + hi) / 2;
+        if ( x <= xp[k] ) hi = k;
+        else lo = k + 1;
+    }
+    return lo;
+}
+
+//=============================================================================
+
 int table_getFirstEntry(TTable *table, double *x, double *y)
 //
 //  Input:   table = pointer to a TTable structure
@@ -334,6 +760,13 @@ int table_getFirstEntry(TTable *table, double *x, double *y)
 
     if ( table->file.mode == USE_FILE )
     {
+        if ( table->fileMap )                                                  //(OPENSWMM 5.1.913)
+        {
+            table->thisPoint = 0;
+            *x = table->xPoints[0];
+            *y = table->yPoints[0];
+            return TRUE;
+        }
         if ( table->file.file == NULL ) return FALSE;
         rewind(table->file.file);
         return table_getNextFileEntry(table, x, y);
@@ -366,8 +799,18 @@ int table_getNextEntry(TTable *table, double *x, double *y)
     TTableEntry *entry;
 
     if ( table->file.mode == USE_FILE )
+    {
+        if ( table->fileMap )                                                  //(OPENSWMM 5.1.913)
+        {
+            if ( table->thisPoint + 1 >= table->nPoints ) return FALSE;
+            table->thisPoint++;
+            *x = table->xPoints[table->thisPoint];
+            *y = table->yPoints[table->thisPoint];
+            return TRUE;
+        }
         return table_getNextFileEntry(table, x, y);
-    
+    }
+
     entry = table->thisEntry->next;
     if ( entry )
     {
@@ -397,8 +840,19 @@ double table_lookup(TTable *table, double x)
 //
 {
     double x1,y1,x2,y2;
+    int    k;                                                                  //(OPENSWMM 5.1.913)
     TTableEntry* entry;
 
+    // --- search the table's point arrays if available                       //(OPENSWMM 5.1.913)
+    if ( table->nPoints > 0 )
+    {
+        if ( x <= table->xPoints[0] ) return table->yPoints[0];
+        k = table_findPoint(table, x);
+        if ( k == table->nPoints ) return table->yPoints[k-1];
+        return table_interpolate(x, table->xPoints[k-1], table->yPoints[k-1],
+                                 table->xPoints[k], table->yPoints[k]);
+    }
+
     entry = table->firstEntry;
     if ( entry == NULL ) return 0.0;
     x1 = entry->x;
@@ -430,8 +884,19 @@ double table_getSlope(TTable *table, double x)
 {
     double x1,y1,x2,y2;
     double dx;
+    int    k;                                                                  //(OPENSWMM 5.1.913)
     TTableEntry* entry;
 
+    // --- search the table's point arrays if available                       //(OPENSWMM 5.1.913)
+    if ( table->nPoints > 0 )
+    {
+        k = table_findPoint(table, x);
+        if ( k == table->nPoints ) return 0.0;
+        dx = table->xPoints[k] - table->xPoints[k-1];
+        if ( dx == 0.0 ) return 0.0;
+        return (table->yPoints[k] - table->yPoints[k-1]) / dx;
+    }
+
     entry = table->firstEntry;
     if ( entry == NULL ) return 0.0;
     x1 = entry->x;
@@ -468,8 +933,30 @@ double table_lookupEx(TTable *table, double x)
 {
     double x1,y1,x2,y2;
     double s = 0.0;
+    int    k, n = table->nPoints;                                              //(OPENSWMM 5.1.913)
     TTableEntry* entry;
 
+    // --- search the table's point arrays if available                       //(OPENSWMM 5.1.913)
+    if ( n > 0 )
+    {
+        x1 = table->xPoints[0];
+        y1 = table->yPoints[0];
+        if ( x <= x1 )
+        {
+            if (x1 > 0.0 ) return x/x1*y1;
+            else return y1;
+        }
+        k = table_findPoint(table, x);
+        if ( k < n ) return table_interpolate(x, table->xPoints[k-1],
+            table->yPoints[k-1], table->xPoints[k], table->yPoints[k]);
+        x1 = table->xPoints[n-1];
+        y1 = table->yPoints[n-1];
+        if ( n > 1 ) s = (y1 - table->yPoints[n-2]) /
+                         (x1 - table->xPoints[n-2]);
+        if ( s < 0.0 ) s = 0.0;
+        return y1 + s*(x - x1);
+    }
+
     entry = table->firstEntry;
     if (entry == NULL ) return 0.0;
     x1 = entry->x;
@@ -506,8 +993,19 @@ double table_intervalLookup(TTable *table, double x)
 //           whose x-value is > x.
 //
 {
+    int k;                                                                     //(OPENSWMM 5.1.913)
     TTableEntry* entry;
 
+    // --- search the table's point arrays if available                       //(OPENSWMM 5.1.913)
+    if ( table->nPoints > 0 )
+    {
+        if ( x < table->xPoints[0] ) return table->yPoints[0];
+        k = table_findPoint(table, x);
+        if ( k < table->nPoints && x == table->xPoints[k] ) k++;
+        if ( k == table->nPoints ) k--;
+        return table->yPoints[k];
+    }
+
     entry = table->firstEntry;
     if (entry == NULL ) return 0.0;
     if ( x < entry->x ) return entry->y;
@@ -537,8 +1035,33 @@ double table_inverseLookup(TTable *table, double y)
 //
 {
     double x1,y1,x2,y2;
+    int    k, lo, hi, n = table->nPoints;                                      //(OPENSWMM 5.1.913)
+    double* yp = table->yPoints;
     TTableEntry* entry;
 
+    // --- search the table's point arrays if available, bisecting them
+    //     if the y-values never fall                                         //(OPENSWMM 5.1.913)
+    if ( n > 0 )
+    {
+        if ( y <= yp[0] ) return table->xPoints[0];
+        if ( table->yFalls == n )
+        {
+            lo = 1;
+            hi = n;
+            while ( lo < hi )
+            {
+                k = (lo + hi) / 2;
+                if ( y <= yp[k] ) hi = k;
+                else lo = k + 1;
+            }
+            k = lo;
+        }
+        else for ( k = 1; k < n && y > yp[k]; k++ );
+        if ( k == n ) return table->xPoints[n-1];
+        return table_interpolate(y, yp[k-1], table->xPoints[k-1],
+                                 yp[k], table->xPoints[k]);
+    }
+
     entry = table->firstEntry;
     if (entry == NULL ) return 0.0;
     x1 = entry->x;
@@ -570,8 +1093,18 @@ double  table_getMaxY(TTable *table, double x)
 //
 {
     double ymax;
+    int    k = table->yFalls;                                                  //(OPENSWMM 5.1.913)
     TTableEntry* entry;
 
+    // --- the search below stops at the first falling y-value if it gets
+    //     that far, which it does if x lies beyond the point before it       //(OPENSWMM 5.1.913)
+    if ( table->nPoints > 0 )
+    {
+        if ( k < table->nPoints && x > table->xPoints[k-1] )
+            return table->yPoints[k-1];
+        return 0.0;
+    }
+
     entry = table->firstEntry;
     ymax = entry->y;
     while ( x > entry->x && entry->next )
@@ -609,8 +1142,34 @@ double  table_getArea(TTable* table, double x)
     double y1, y2;
     double dx = 0.0, dy = 0.0;
     double a, s = 0.0;
+    int    k, n = table->nPoints;                                              //(OPENSWMM 5.1.913)
     TTableEntry* entry;
 
+    // --- use the table's cumulative areas if available                      //(OPENSWMM 5.1.913)
+    if ( table->aPoints )
+    {
+        x1 = table->xPoints[0];
+        y1 = table->yPoints[0];
+        if ( x1 > 0.0 ) s = y1/x1;
+        if ( x <= x1 ) return s*x*x/2.0;
+        k = table_findPoint(table, x);
+        if ( k < n )
+        {
+            x1 = table->xPoints[k-1];
+            y1 = table->yPoints[k-1];
+            y2 = table_interpolate(x, x1, y1, table->xPoints[k],
+                                   table->yPoints[k]);
+            return table->aPoints[k-1] + (x - x1) * (y1 + y2) / 2.0;
+        }
+        x1 = table->xPoints[n-1];
+        y1 = table->yPoints[n-1];
+        s = 0.0;
+        if ( n > 1 ) s = (y1 - table->yPoints[n-2]) /
+                         (x1 - table->xPoints[n-2]);
+        dx = x - x1;
+        return table->aPoints[n-1] + y1*dx + s*dx*dx/2.0;
+    }
+
     // --- get area up to first table entry
     //     and see if x-value lies in this interval
     entry = table->firstEntry;
@@ -665,8 +1224,71 @@ double  table_getInverseArea(TTable* table, double a)
     double y1, y2;
     double dx = 0.0, dy = 0.0;
     double a1, a2, s;
+    int    k, lo, hi, n = table->nPoints;                                      //(OPENSWMM 5.1.913)
+    double* ap = table->aPoints;
     TTableEntry* entry;
 
+    // --- bisect the table's cumulative areas if available                   //(OPENSWMM 5.1.913)
+    if ( ap )
+    {
+        x1 = table->xPoints[0];
+        y1 = table->yPoints[0];
+        if ( a <= ap[0] )
+        {
+            if ( y1 > 0.0 ) return sqrt(2.0*a*x1/y1);
+            else return 0.0;
+        }
+        lo = 1;
+        hi = n;
+        while ( lo < hi )
+        {
+            k = (lo + hi) / 2;
+            if ( a <= ap[k] ) hi = k;
+            else lo = k + 1;
+        }
+        k = lo;
+
+        // --- past the last point the last interval is extrapolated
+        if ( k == n ) k = n - 1;
+        a1 = ap[MAX(k-1, 0)];
+        a2 = ap[k];
+        x1 = table->xPoints[MAX(k-1, 0)];
+        y1 = table->yPoints[MAX(k-1, 0)];
+        x2 = table->xPoints[k];
+        y2 = table->yPoints[k];
+        dx = x2 - x1;
+        dy = y2 - y1;
+        if ( a > a2 )
+        {
+            if ( dx == 0.0 || dy == 0.0 )
+            {
+                if ( y2 > 0.0 ) dx = (a - a2) / y2;
+                else dx = 0.0;
+            }
+            else
+            {
+                s = dy/dx;
+                dx = (sqrt(y2*y2 + 2.0*s*(a-a2)) - y2) / s;
+                if (dx < 0.0) dx = 0.0;
+            }
+            return x2 + dx;
+        }
+        if ( dy == 0.0 )
+        {
+            if ( a2 == a1 ) return x1;
+            else return x1 + dx * (a - a1) / (a2 - a1);
+        }
+        if ( dy < 0.0 )
+        {
+            x1 = x2;
+            y1 = y2;
+            a1 = a2;
+        }
+        s = dy/dx;
+        dx = (sqrt(y1*y1 + 2.0*s*(a-a1)) - y1) / s;
+        return x1 + dx;
+    }
+
     // --- see if target area is below that of 1st table entry
     entry = table->firstEntry;
     if (entry == NULL ) return 0.0;
@@ -802,6 +1424,60 @@ double table_tseriesLookup(TTable *table, double x, char extend)
 
 //=============================================================================
 
+double table_tseriesLookupAt(TTable *table, int *cursor, double x, char extend)
+//
+//  Input:   table = pointer to a TTable structure
+//           cursor = index of the point that ends the time interval last
+//                    found by the caller (0 if none)
+//           x = a date/time value
+//           extend = TRUE if time series extended on either end
+//  Output:  returns a y-value and updates cursor
+//  Purpose: retrieves the y-value corresponding to a time series date for
+//           a caller that keeps its own position in the time series.
+//
+//  NOTE: the caller's current and next time intervals are checked before
+//        x is located in the series' point arrays, so x can move in either
+//        direction. A time series read from an external file has no point
+//        arrays and is looked up with table_tseriesLookup instead.
+//
+{
+    int     n = table->nPoints;
+    int     k = *cursor;
+    double* xp = table->xPoints;
+    double* yp = table->yPoints;
+
+    if ( n == 0 ) return table_tseriesLookup(table, x, extend);
+
+    // --- x lies before start of time series
+    if ( x < xp[0] )
+    {
+        if ( extend == TRUE ) return yp[0];
+        else return 0.0;
+    }
+
+    // --- x lies outside of current time interval
+    if ( k < 1 || k >= n || x < xp[k-1] || x > xp[k] )
+    {
+        // --- x lies in next time interval
+        if ( k >= 1 && k < n-1 && x > xp[k] && x <= xp[k+1] ) k++;
+
+        // --- otherwise search the entire time series
+        else
+        {
+            k = table_findPoint(table, x);
+            if ( k == n )
+            {
+                if ( extend == TRUE ) return yp[n-1];
+                else return 0.0;
+            }
+        }
+        *cursor = k;
+    }
+    return table_interpolate(x, xp[k-1], yp[k-1], xp[k], yp[k]);
+}
+
+//=============================================================================
+
 int  table_getNextFileEntry(TTable* table, double* x, double* y)
 //
 //  Input:   table = pointer to a TTable structure
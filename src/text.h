@@ -104,6 +104,14 @@
 #define  w_MIN_ROUTE_STEP    "MINIMUM_STEP"                                    //(5.1.008)
 #define  w_NUM_THREADS       "THREADS"                                         //(5.1.008)
 #define  w_Water_Age         "Water_Age"	   //(OPENSWMM 5.1.912)
+#define  w_SOLVER_METHOD     "SOLVER_METHOD"                                   //(OPENSWMM 5.1.913)
+#define  w_MULTIRATE_CLASSES "MULTIRATE_CLASSES"                               //(OPENSWMM 5.1.913)
+#define  w_SOLVER_ACCEL      "SOLVER_ACCELERATION"                             //(OPENSWMM 5.1.913)
+#define  w_SOLVER_PREDICTOR  "SOLVER_PREDICTOR"                                //(OPENSWMM 5.1.913)
+#define  w_GEOMETRY_TOL      "GEOMETRY_TABLE_TOL"                              //(OPENSWMM 5.1.913)
+#define  w_CHECK_GEOM_TABLES "CHECK_GEOMETRY_TABLES"                           //(OPENSWMM 5.1.913)
+#define  w_STORAGE_TOL       "STORAGE_TABLE_TOL"                               //(OPENSWMM 5.1.913)
+#define  w_FRICTION_TABLE    "FRICTION_FACTOR_TABLE"                           //(OPENSWMM 5.1.913)
 
 // Flow Units
 #define  w_CFS               "CFS"
@@ -235,6 +243,11 @@
 #define  w_H_W               "H-W"
 #define  w_D_W               "D-W" 
 
+// Dynamic Wave Solver Methods                                                 //(OPENSWMM 5.1.913)
+#define  w_PICARD            "PICARD"
+#define  w_NEWTON            "NEWTON"
+#define  w_ANDERSON          "ANDERSON"
+
 // Link Offset Options
 #define  w_ELEVATION         "ELEVATION"
 
@@ -7,6 +7,11 @@
 //   Author:   L. Rossman
 //
 //   Topological sorting of conveyance network links
+//
+//   OpenSWMM 5.1.913:
+//   - Added an ordering of nodes & links that keeps neighboring elements
+//     of the network close together for dynamic wave routing and that
+//     identifies the network's hydraulically independent components.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -40,6 +45,7 @@ static int   LoopLinksLast;            // number of links in a loop
 //  External functions (declared in funcs.h)   
 //-----------------------------------------------------------------------------
 //  toposort_sortLinks (called by routing_open)
+//  toposort_sortForLocality (called by dynwave_init)                         //(OPENSWMM 5.1.913)
 
 //-----------------------------------------------------------------------------
 //  Local functions
@@ -52,6 +58,8 @@ static void findSpanningTree(int startNode);
 static void evalLoop(int startLink);
 static int  traceLoop(int i1, int i2, int k);
 static void checkDummyLinks(void);
+static int  visitNeighbors(int root, int k, int order[], int adjStart[],
+            int adjList[], char* marked);                                      //(OPENSWMM 5.1.913)
 //=============================================================================
 
 void toposort_sortLinks(int sortedLinks[])
@@ -529,3 +537,173 @@ void checkDummyLinks()
 }
 
 //=============================================================================
+
+////  New functions added to release 5.1.913.  ////                            //(OPENSWMM 5.1.913)
+
+int toposort_sortForLocality(int sortedNodes[], int sortedLinks[],
+                             int component[])
+//
+//  Input:   none
+//  Output:  sortedNodes = array of node indexes in processing order
+//           sortedLinks = array of link indexes in processing order
+//           component = connected component each node belongs to
+//           returns number of connected components
+//  Purpose: orders nodes & links so that elements that are neighbors in
+//           the network are also close together in the ordering.
+//
+//  Note:    Nodes are ordered by a reverse Cuthill-McKee search that starts
+//           from each outfall in turn, so the ordering runs from the head
+//           of each drainage area down to its outfall. Links follow the
+//           order of the first of their end nodes to be listed. Each
+//           connected component occupies a contiguous stretch of both
+//           orderings, with components numbered in the order they appear.
+//
+{
+    int    i, j, k, m, n, c;
+    int    nNodes = Nobjects[NODE];
+    int    nLinks = Nobjects[LINK];
+    int*   adjStart;
+    int*   adjList;
+    char*  marked;
+
+    // --- default is the order of input
+    for (i = 0; i < nNodes; i++) sortedNodes[i] = i;
+    for (j = 0; j < nLinks; j++) sortedLinks[j] = j;
+    for (i = 0; i < nNodes; i++) component[i] = 0;
+    if ( nNodes == 0 ) return 0;
+    c = 1;
+
+    // --- allocate an undirected adjacency list of neighboring nodes
+    adjStart = (int *) calloc(nNodes+1, sizeof(int));
+    adjList  = (int *) calloc(MAX(2*nLinks, nNodes)+1, sizeof(int));
+    marked   = (char *) calloc(nNodes, sizeof(char));
+    if ( adjStart == NULL || adjList == NULL || marked == NULL )
+    {
+        report_writeErrorMsg(ERR_MEMORY, "");
+    }
+    else
+    {
+        // --- count each node's neighbors & find where they start
+        for (j = 0; j < nLinks; j++)
+        {
+            adjStart[Link[j].node1+1]++;
+            adjStart[Link[j].node2+1]++;
+        }
+        for (i = 0; i < nNodes; i++) adjStart[i+1] += adjStart[i];
+
+        // --- list the neighbors (sortedNodes holds each node's fill count)
+        for (i = 0; i < nNodes; i++) sortedNodes[i] = adjStart[i];
+        for (j = 0; j < nLinks; j++)
+        {
+            i = Link[j].node1;
+            n = Link[j].node2;
+            adjList[sortedNodes[i]++] = n;
+            adjList[sortedNodes[n]++] = i;
+        }
+
+        // --- search outward from each outfall, then from any node that
+        //     can't reach one (each search covers one component)
+        k = 0;
+        c = 0;
+        for (i = 0; i < nNodes; i++)
+        {
+            if ( Node[i].type == OUTFALL && !marked[i] )
+            {
+                m = k;
+                k = visitNeighbors(i, k, sortedNodes, adjStart, adjList, marked);
+                while ( m < k ) component[sortedNodes[m++]] = c;
+                c++;
+            }
+        }
+        for (i = 0; i < nNodes; i++)
+        {
+            if ( !marked[i] )
+            {
+                m = k;
+                k = visitNeighbors(i, k, sortedNodes, adjStart, adjList, marked);
+                while ( m < k ) component[sortedNodes[m++]] = c;
+                c++;
+            }
+        }
+
+        // --- reverse the search order
+        for (m = 0; m < nNodes/2; m++)
+        {
+            i = sortedNodes[m];
+            sortedNodes[m] = sortedNodes[nNodes-1-m];
+            sortedNodes[nNodes-1-m] = i;
+        }
+
+        // --- number the components in the order they now appear
+        for (i = 0; i < nNodes; i++) component[i] = c - 1 - component[i];
+
+        // --- list links in the order their first end node was listed
+        //     (adjStart now holds each node's position in the ordering and
+        //     adjList where each node's links start)
+        for (m = 0; m < nNodes; m++) adjStart[sortedNodes[m]] = m;
+        for (m = 0; m <= nNodes; m++) adjList[m] = 0;
+        for (j = 0; j < nLinks; j++)
+        {
+            adjList[MIN(adjStart[Link[j].node1], adjStart[Link[j].node2])+1]++;
+        }
+        for (m = 0; m < nNodes; m++) adjList[m+1] += adjList[m];
+        for (j = 0; j < nLinks; j++)
+        {
+            m = MIN(adjStart[Link[j].node1], adjStart[Link[j].node2]);
+            sortedLinks[adjList[m]++] = j;
+        }
+    }
+
+    // --- free allocated memory
+    FREE(adjStart);
+    FREE(adjList);
+    FREE(marked);
+    return c;
+}
+
+//=============================================================================
+
+int visitNeighbors(int root, int k, int order[], int adjStart[],
+                   int adjList[], char* marked)
+//
+//  Input:   root = node where search starts
+//           k = next free position in order
+//           order = node ordering being built
+//           adjStart = start of each node's neighbors in adjList
+//           adjList = list of neighbors of each node
+//           marked = TRUE for nodes already placed in the ordering
+//  Output:  returns next free position in the ordering
+//  Purpose: adds the nodes connected to root to the ordering in breadth
+//           first order, visiting neighbors in order of increasing degree.
+//
+{
+    int i, j, m, n, n0, head, tail;
+
+    head = k;
+    tail = k;
+    order[tail++] = root;
+    marked[root] = TRUE;
+    while ( head < tail )
+    {
+        i = order[head++];
+        n0 = tail;
+        for (m = adjStart[i]; m < adjStart[i+1]; m++)
+        {
+            j = adjList[m];
+            if ( marked[j] ) continue;
+            marked[j] = TRUE;
+
+            // --- insertion sort of newly reached nodes by degree
+            n = tail;
+            while ( n > n0 && adjStart[order[n-1]+1] - adjStart[order[n-1]] >
+                              adjStart[j+1] - adjStart[j] )
+            {
+                order[n] = order[n-1];
+                n--;
+            }
+            order[n] = j;
+            tail++;
+        }
+    }
+    return tail;
+}
@@ -7,6 +7,10 @@
 //   Author:   L. Rossman
 //
 //   Geometry processing for irregular cross-section transects.
+//
+//   OpenSWMM 5.1.913:
+//   - Geometry tables are built in a scratch array and then replaced by a
+//     copy shared by all transects with identical tables.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -35,6 +39,8 @@ static double  Xrightbank;             // station where right overbank begins
 static double  Xfactor;                // multiplier for station spacing
 static double  Yfactor;                // factor added to station elevations
 static double  Lfactor;                // main channel/flood plain length
+static double  Tables[3*N_TRANSECT_TBL];      // scratch geometry tables       //(OPENSWMM 5.1.913)
+static double  EmptyTables[3*N_TRANSECT_TBL]; // tables of invalid transects
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)   
@@ -55,6 +61,7 @@ static void   getGeometry(int i, int j, double y);
 static void   getSliceGeom(int k, double y, double yu, double yd, double *w,
               double *a, double *wp);
 static void   setMaxSectionFactor(int transect);
+static void   setTables(int transect, double* tables);                         //(OPENSWMM 5.1.913)
 
 //=============================================================================
 
@@ -65,10 +72,13 @@ int transect_create(int n)
 //  Purpose: creates an array of cross-section transects.
 //
 {
+    int j;                                                                     //(OPENSWMM 5.1.913)
+
     Ntransects = n;
     if ( n == 0 ) return 0;
     Transect = (TTransect *) calloc(Ntransects, sizeof(TTransect));
     if ( Transect == NULL ) return ERR_MEMORY;
+    for (j = 0; j < Ntransects; j++) setTables(j, EmptyTables);                //(OPENSWMM 5.1.913)
     Nchannel = 0.0;
     Nleft = 0.0;
     Nright = 0.0;
@@ -192,6 +202,7 @@ void  transect_validate(int j)
     int    i, nLast;
     double dy, y, ymin, ymax;
     double oldNchannel = Nchannel;
+    double* tables;                                                            //(OPENSWMM 5.1.913)
 
     // --- check for valid transect data
     if ( j < 0 || j >= Ntransects ) return;
@@ -244,6 +255,7 @@ void  transect_validate(int j)
     Elev[Nstations] = Elev[0];
 
     // --- determine size & depth increment for geometry tables
+    setTables(j, Tables);                                                      //(OPENSWMM 5.1.913)
     Transect[j].nTbl = N_TRANSECT_TBL;
     dy = (ymax - ymin) / (double)(Transect[j].nTbl - 1);
 
@@ -286,6 +298,15 @@ void  transect_validate(int j)
 
     // --- save unadjusted main channel roughness 
     Transect[j].roughness = oldNchannel;
+
+    // --- replace scratch tables with a shared copy                           //(OPENSWMM 5.1.913)
+    tables = xsect_shareTables(Tables, 3*N_TRANSECT_TBL);
+    if ( tables == NULL )
+    {
+        report_writeErrorMsg(ERR_MEMORY, Transect[j].ID);
+        tables = EmptyTables;
+    }
+    setTables(j, tables);
 }
 
 //=============================================================================
@@ -570,3 +591,19 @@ void setMaxSectionFactor(int j)
 }
 
 //=============================================================================
+
+////  New function added to release 5.1.913.  ////                             //(OPENSWMM 5.1.913)
+
+void setTables(int j, double* tables)
+//
+//  Input:   j = transect index
+//           tables = array holding the three geometry tables
+//  Output:  none
+//  Purpose: points a transect's geometry tables at consecutive sections of
+//           an array.
+//
+{
+    Transect[j].areaTbl = tables;
+    Transect[j].hradTbl = tables + N_TRANSECT_TBL;
+    Transect[j].widthTbl = tables + 2*N_TRANSECT_TBL;
+}
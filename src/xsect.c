@@ -27,9 +27,29 @@
 //
 //   Build 5.1.012:
 //   - Height at max. width for Modified Baskethandle shape corrected.
+//
+//   OpenSWMM 5.1.913:
+//   - Batch versions of getAofY, getWofY, getRofY and getSofA evaluate a
+//     geometry function over arrays of cross sections grouped by shape,
+//     with vectorizable kernels for circular, rectangular and trapezoidal
+//     shapes.
+//   - When the GEOMETRY_TABLE_TOL option is set, getAofS (and getYofA for
+//     shapes whose depth is found by inverse table lookup) first interpolate
+//     from a uniform grid table built for each distinct cross section. Grid
+//     intervals where interpolation misses the tolerance use the exact
+//     method instead.
+//   - Critical depth and normal depth (depth v. section factor) are also
+//     tabulated for shapes whose depths come from a root finding search
+//     or from composing two inverse functions. The CHECK_GEOMETRY_TABLES
+//     option compares these tables against the exact solutions.
+//   - Inverse tables, transect tables and custom shape tables are shared
+//     by all objects with identical geometry through a hash table keyed on
+//     the values that define them.
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
+#include <stdlib.h>                                                            //(OPENSWMM 5.1.913)
+#include <string.h>                                                            //(OPENSWMM 5.1.913)
 #include <math.h>
 #include "headers.h"
 #include "findroot.h"
@@ -37,6 +57,11 @@
 #define  RECT_ALFMAX        0.97
 #define  RECT_TRIANG_ALFMAX 0.98
 #define  RECT_ROUND_ALFMAX  0.98
+#define  MIN_INV_INTERVALS  64     // initial # intervals in an inverse table  //(OPENSWMM 5.1.913)
+#define  MAX_INV_INTERVALS  4096   // max. # intervals in an inverse table
+#define  N_GEOMETRY_KEY     13     // # values identifying a section's geometry
+#define  YCRIT_REF_DEPTH    0.95   // top of critical depth table / full depth
+#define  N_CHECK_POINTS     8      // # points checked per table grid interval
 
 #include "xsect.dat"    // File containing geometry tables for rounded shapes
 
@@ -82,6 +107,31 @@ typedef struct
     TXsect* xsect;            // pointer to a cross section object
 } TXsectStar;
 
+// Record of a shared set of geometry tables, kept in an open addressing hash
+// table keyed on the values that define the tables                            //(OPENSWMM 5.1.913)
+typedef struct
+{
+    unsigned int hash;        // hash code of key values
+    int          nKey;        // number of key values
+    double*      key;         // key values (NULL if slot is empty)
+    TInvTable*   aOfS;        // shared table of area v. section factor
+    TInvTable*   yOfA;        // shared table of depth v. area
+    TInvTable*   yOfS;        // shared table of depth v. section factor
+    TInvTable*   yCrit;       // shared table of critical depth v. flow
+} TGeomRecord;
+
+static TGeomRecord* GeomRecords;     // hash table of shared geometry records
+static int          GeomRecordCount; // number of records in use
+static int          GeomRecordSize;  // size of hash table (a power of 2)
+
+// Largest differences (as fractions of full depth) between tabulated and
+// exact critical and normal depths                                            //(OPENSWMM 5.1.913)
+static double MaxYcritError;
+static double MaxYnormError;
+
+// Geometry functions evaluated by the batch functions                         //(OPENSWMM 5.1.913)
+enum BatchFuncType {AOFY, WOFY, ROFY, SOFA};
+
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
@@ -89,16 +139,25 @@ typedef struct
 //  xsect_setParams
 //  xsect_setIrregXsectParams
 //  xsect_setCustomXsectParams
+//  xsect_createInvTables
+//  xsect_shareTables
+//  xsect_deleteSharedTables
+//  xsect_getTableErrors
 //  xsect_getAmax
 //  xsect_getSofA
 //  xsect_getYofA
 //  xsect_getRofA
 //  xsect_getAofS
+//  xsect_getYofS
 //  xsect_getdSdA
 //  xsect_getAofY
 //  xsect_getRofY
 //  xsect_getWofY
 //  xsect_getYcrit
+//  xsect_getAofYs
+//  xsect_getWofYs
+//  xsect_getRofYs
+//  xsect_getSofAs
 
 //-----------------------------------------------------------------------------
 //  Local functions
@@ -111,6 +170,34 @@ static double lookup(double x, double *table, int nItems);
 static double invLookup(double y, double *table, int nItems);
 static int    locate(double y, double *table, int nItems);
 
+static int    getGeometryKey(TXsect* xsect, double key[]);                     //(OPENSWMM 5.1.913)
+static unsigned int getKeyHash(double key[], int nKey);
+static TGeomRecord* findGeomRecord(double key[], int nKey, unsigned int hash);
+static TGeomRecord* addGeomRecord(double key[], int nKey, unsigned int hash);
+static TInvTable* invTable_create(TXsect* xsect,
+              double (*f)(TXsect* xsect, double u));
+static void   invTable_delete(TInvTable* table);
+static int    invTable_lookup(TInvTable* table, double u, double* x);
+static double invTable_getAofS(TXsect* xsect, double psi);
+static double invTable_getYofA(TXsect* xsect, double alpha);
+static double invTable_getYofS(TXsect* xsect, double psi);
+static double invTable_getYcrit(TXsect* xsect, double u);
+static double invTable_getQref(TXsect* xsect);
+static void   invTable_check(TXsect* xsect);
+
+static void   getBatch(int func, TXsect* xsect[], double x[], double f[],     //(OPENSWMM 5.1.913)
+              int n);
+static double getScalar(int func, TXsect* xsect, double x);
+static double lookupKernel(double x, double *table, int nItems);
+static void   circ_batch(int func, TXsect* xsect[], double x[], double f[],
+              int n);
+static void   rect_closed_batch(int func, TXsect* xsect[], double x[],
+              double f[], int n);
+static void   rect_open_batch(int func, TXsect* xsect[], double x[],
+              double f[], int n);
+static void   trapez_batch(int func, TXsect* xsect[], double x[], double f[],
+              int n);
+
 static double rect_closed_getSofA(TXsect* xsect, double a);
 static double rect_closed_getdSdA(TXsect* xsect, double a);
 static double rect_closed_getRofA(TXsect* xsect, double a);
@@ -694,6 +781,164 @@ void xsect_setCustomXsectParams(TXsect *xsect)
 
 //=============================================================================
 
+////  New functions added to release 5.1.913.  ////                            //(OPENSWMM 5.1.913)
+
+void xsect_createInvTables(TXsect *xsect)
+//
+//  Input:   xsect = ptr. to a cross section data structure
+//  Output:  none
+//  Purpose: assigns inverse geometry tables to a cross section, building
+//           them if no section with the same geometry already has them.
+//
+//  NOTE: a table of area v. section factor is built for all shapes, while
+//        one of depth v. area is built only for shapes whose depth would
+//        otherwise come from an inverse lookup in their geometry tables.
+//
+{
+    int          nKey;
+    unsigned int hash;
+    double       key[N_GEOMETRY_KEY];
+    TGeomRecord* record;
+
+    if ( xsect->type == DUMMY || xsect->aOfS ) return;
+
+    // --- use the tables of a section with the same geometry
+    nKey = getGeometryKey(xsect, key);
+    hash = getKeyHash(key, nKey);
+    record = findGeomRecord(key, nKey, hash);
+    if ( record && record->key )
+    {
+        xsect->aOfS = record->aOfS;
+        xsect->yOfA = record->yOfA;
+        xsect->yOfS = record->yOfS;
+        xsect->yCrit = record->yCrit;
+        return;
+    }
+
+    // --- build the tables (the depth v. area table comes last since
+    //     the exact versions of the other relations may use it)
+    record = addGeomRecord(key, nKey, hash);
+    if ( record == NULL ) return;
+    switch ( xsect->type )
+    {
+      case RECT_OPEN:
+      case RECT_CLOSED:
+      case TRIANGULAR:
+      case PARABOLIC:
+      case POWERFUNC:
+        break;
+      default:
+        if ( invTable_getQref(xsect) <= 0.0 ) break;
+        xsect->yCrit = invTable_create(xsect, invTable_getYcrit);
+        if ( xsect->yCrit ) xsect->yCrit->ref = invTable_getQref(xsect);
+    }
+    xsect->yOfS = invTable_create(xsect, invTable_getYofS);
+    xsect->aOfS = invTable_create(xsect, invTable_getAofS);
+    switch ( xsect->type )
+    {
+      case HORIZ_ELLIPSE:
+      case VERT_ELLIPSE:
+      case ARCH:
+      case IRREGULAR:
+      case CUSTOM:
+        xsect->yOfA = invTable_create(xsect, invTable_getYofA);
+    }
+    record->aOfS = xsect->aOfS;
+    record->yOfA = xsect->yOfA;
+    record->yOfS = xsect->yOfS;
+    record->yCrit = xsect->yCrit;
+
+    // --- compare the new tables against exact solutions if called for
+    if ( CheckGeomTables ) invTable_check(xsect);
+}
+
+//=============================================================================
+
+double* xsect_shareTables(double tables[], int n)
+//
+//  Input:   tables = array of geometry table entries
+//           n = number of entries
+//  Output:  returns a pointer to a shared copy of the entries (or NULL if
+//           out of memory)
+//  Purpose: finds the shared copy of a set of geometry tables, adding one
+//           if no identical set has been shared before.
+//
+//  NOTE: used by transects and custom shapes so that objects with identical
+//        tables keep a single copy of them. A shared copy must never be
+//        modified.
+//
+{
+    unsigned int hash = getKeyHash(tables, n);
+    TGeomRecord* record = findGeomRecord(tables, n, hash);
+
+    if ( record && record->key ) return record->key;
+    record = addGeomRecord(tables, n, hash);
+    if ( record == NULL ) return NULL;
+    return record->key;
+}
+
+//=============================================================================
+
+void xsect_deleteSharedTables(void)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees all shared geometry tables.
+//
+{
+    int i;
+
+    for (i = 0; i < GeomRecordSize; i++)
+    {
+        if ( GeomRecords[i].key == NULL ) continue;
+        free(GeomRecords[i].key);
+        invTable_delete(GeomRecords[i].aOfS);
+        invTable_delete(GeomRecords[i].yOfA);
+        invTable_delete(GeomRecords[i].yOfS);
+        invTable_delete(GeomRecords[i].yCrit);
+    }
+    FREE(GeomRecords);
+    GeomRecordCount = 0;
+    GeomRecordSize = 0;
+    MaxYcritError = 0.0;
+    MaxYnormError = 0.0;
+}
+
+//=============================================================================
+
+void xsect_getTableErrors(double* yCritErr, double* yNormErr)
+//
+//  Input:   none
+//  Output:  yCritErr = largest error in tabulated critical depth
+//           yNormErr = largest error in tabulated normal depth
+//  Purpose: retrieves the largest differences, as fractions of full depth,
+//           found between tabulated and exact depths when the tables were
+//           checked.
+//
+{
+    *yCritErr = MaxYcritError;
+    *yNormErr = MaxYnormError;
+}
+
+//=============================================================================
+
+double xsect_getYofS(TXsect* xsect, double s)
+//
+//  Input:   xsect = ptr. to a cross section data structure
+//           s = section factor (ft^(8/3))
+//  Output:  returns depth (ft)
+//  Purpose: computes xsection's depth at a given section factor.
+//
+{
+    double y;
+
+    if ( xsect->yOfS && invTable_lookup(xsect->yOfS, s / xsect->sFull, &y) )
+        return xsect->yFull * y;
+    return xsect_getYofA(xsect, xsect_getAofS(xsect, s));
+}
+
+//=============================================================================
+
 double xsect_getAmax(TXsect* xsect)
 //
 //  Input:   xsect = ptr. to a cross section data structure
@@ -776,6 +1021,10 @@ double xsect_getYofA(TXsect *xsect, double a)
 //
 {
     double alpha = a / xsect->aFull;
+    double yNorm;                                                              //(OPENSWMM 5.1.913)
+
+    if ( xsect->yOfA && invTable_lookup(xsect->yOfA, alpha, &yNorm) )
+        return xsect->yFull * yNorm;
     switch ( xsect->type )
     {
       case FORCE_MAIN:
@@ -1129,7 +1378,11 @@ double xsect_getAofS(TXsect* xsect, double s)
 //
 {
     double psi = s / xsect->sFull;
+    double alpha;                                                              //(OPENSWMM 5.1.913)
+
     if ( s <= 0.0 ) return 0.0;
+    if ( xsect->aOfS && invTable_lookup(xsect->aOfS, psi, &alpha) )
+        return xsect->aFull * alpha;
     if ( s > xsect->sMax ) s = xsect->sMax;
     switch ( xsect->type )
     {
@@ -1271,6 +1524,14 @@ double xsect_getYcrit(TXsect* xsect, double q)
         break;
 
       default:
+        // --- interpolate yCritical from a table if possible                  //(OPENSWMM 5.1.913)
+        if ( xsect->yCrit && invTable_lookup(xsect->yCrit,
+             sqrt(q / xsect->yCrit->ref), &y) )
+        {
+            y *= xsect->yFull;
+            break;
+        }
+
         // --- first estimate yCritical for an equivalent circular conduit
         //     using 1.01 * (q2g / yFull)^(1/4)
         y = 1.01 * pow(q2g / xsect->yFull, 1./4.);
@@ -1294,6 +1555,66 @@ double xsect_getYcrit(TXsect* xsect, double q)
 
 //=============================================================================
 
+////  New functions added to release 5.1.913.  ////                            //(OPENSWMM 5.1.913)
+
+void xsect_getAofYs(TXsect* xsect[], double y[], double a[], int n)
+//
+//  Input:   xsect = array of ptrs. to cross section data structures
+//           y = array of depths (ft)
+//           n = number of items in the arrays
+//  Output:  a = array of areas (ft2)
+//  Purpose: computes areas for a batch of (cross section, depth) pairs.
+//
+{
+    getBatch(AOFY, xsect, y, a, n);
+}
+
+//=============================================================================
+
+void xsect_getWofYs(TXsect* xsect[], double y[], double w[], int n)
+//
+//  Input:   xsect = array of ptrs. to cross section data structures
+//           y = array of depths (ft)
+//           n = number of items in the arrays
+//  Output:  w = array of top widths (ft)
+//  Purpose: computes top widths for a batch of (cross section, depth) pairs.
+//
+{
+    getBatch(WOFY, xsect, y, w, n);
+}
+
+//=============================================================================
+
+void xsect_getRofYs(TXsect* xsect[], double y[], double r[], int n)
+//
+//  Input:   xsect = array of ptrs. to cross section data structures
+//           y = array of depths (ft)
+//           n = number of items in the arrays
+//  Output:  r = array of hydraulic radii (ft)
+//  Purpose: computes hydraulic radii for a batch of (cross section, depth)
+//           pairs.
+//
+{
+    getBatch(ROFY, xsect, y, r, n);
+}
+
+//=============================================================================
+
+void xsect_getSofAs(TXsect* xsect[], double a[], double s[], int n)
+//
+//  Input:   xsect = array of ptrs. to cross section data structures
+//           a = array of areas (ft2)
+//           n = number of items in the arrays
+//  Output:  s = array of section factors (ft^(8/3))
+//  Purpose: computes section factors for a batch of (cross section, area)
+//           pairs.
+//
+{
+    getBatch(SOFA, xsect, a, s, n);
+}
+
+//=============================================================================
+
 double generic_getAofS(TXsect* xsect, double s)
 //
 //  Input:   xsect = ptr. to a cross section data structure
@@ -1547,6 +1868,362 @@ int locate(double y, double *table, int jLast)
 
 //=============================================================================
 
+////  New functions added to release 5.1.913.  ////                            //(OPENSWMM 5.1.913)
+
+int getGeometryKey(TXsect* xsect, double key[])
+//
+//  Input:   xsect = ptr. to a cross section data structure
+//  Output:  key = values that define the section's geometry;
+//           returns the number of key values
+//  Purpose: collects the parameters that identify cross sections which can
+//           share inverse geometry tables.
+//
+{
+    key[0]  = xsect->type;
+    key[1]  = xsect->transect;
+    key[2]  = xsect->yFull;
+    key[3]  = xsect->wMax;
+    key[4]  = xsect->ywMax;
+    key[5]  = xsect->aFull;
+    key[6]  = xsect->rFull;
+    key[7]  = xsect->sFull;
+    key[8]  = xsect->sMax;
+    key[9]  = xsect->yBot;
+    key[10] = xsect->aBot;
+    key[11] = xsect->sBot;
+    key[12] = xsect->rBot;
+    return N_GEOMETRY_KEY;
+}
+
+//=============================================================================
+
+unsigned int getKeyHash(double key[], int nKey)
+//
+//  Input:   key = array of key values
+//           nKey = number of key values
+//  Output:  returns a hash code
+//  Purpose: computes the FNV-1a hash code of the bytes of a set of key
+//           values.
+//
+{
+    unsigned int   hash = 2166136261u;
+    unsigned char* b = (unsigned char *)key;
+    size_t         i, n = nKey * sizeof(double);
+
+    for (i = 0; i < n; i++)
+    {
+        hash ^= b[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+//=============================================================================
+
+TGeomRecord* findGeomRecord(double key[], int nKey, unsigned int hash)
+//
+//  Input:   key = array of key values
+//           nKey = number of key values
+//           hash = hash code of key values
+//  Output:  returns a pointer to the record with the same key, to the
+//           empty slot where such a record belongs, or NULL if there is
+//           no table of records yet
+//  Purpose: searches the table of shared geometry records.
+//
+{
+    unsigned int i, mask;
+    TGeomRecord* record;
+
+    if ( GeomRecordSize == 0 ) return NULL;
+    mask = GeomRecordSize - 1;
+    for (i = hash & mask; ; i = (i + 1) & mask)
+    {
+        record = &GeomRecords[i];
+        if ( record->key == NULL ) return record;
+        if ( record->hash == hash && record->nKey == nKey &&
+             memcmp(record->key, key, nKey * sizeof(double)) == 0 )
+            return record;
+    }
+}
+
+//=============================================================================
+
+TGeomRecord* addGeomRecord(double key[], int nKey, unsigned int hash)
+//
+//  Input:   key = array of key values
+//           nKey = number of key values
+//           hash = hash code of key values
+//  Output:  returns a pointer to a new record holding a copy of the key
+//           values (or NULL if out of memory)
+//  Purpose: adds a record to the table of shared geometry records.
+//
+{
+    int          i, oldSize;
+    TGeomRecord* oldRecords;
+    TGeomRecord* record;
+
+    // --- keep the table no more than half full
+    if ( 2 * (GeomRecordCount + 1) > GeomRecordSize )
+    {
+        oldRecords = GeomRecords;
+        oldSize = GeomRecordSize;
+        GeomRecordSize = (oldSize == 0) ? 64 : 2 * oldSize;
+        GeomRecords = (TGeomRecord *) calloc(GeomRecordSize,
+                      sizeof(TGeomRecord));
+        if ( GeomRecords == NULL )
+        {
+            GeomRecords = oldRecords;
+            GeomRecordSize = oldSize;
+            return NULL;
+        }
+        for (i = 0; i < oldSize; i++)
+        {
+            if ( oldRecords[i].key == NULL ) continue;
+            record = findGeomRecord(oldRecords[i].key, oldRecords[i].nKey,
+                                    oldRecords[i].hash);
+            *record = oldRecords[i];
+        }
+        FREE(oldRecords);
+    }
+
+    // --- fill in the empty slot for the new key
+    record = findGeomRecord(key, nKey, hash);
+    record->key = (double *) malloc(nKey * sizeof(double));
+    if ( record->key == NULL ) return NULL;
+    memcpy(record->key, key, nKey * sizeof(double));
+    record->nKey = nKey;
+    record->hash = hash;
+    record->aOfS = NULL;
+    record->yOfA = NULL;
+    GeomRecordCount++;
+    return record;
+}
+
+//=============================================================================
+
+TInvTable* invTable_create(TXsect* xsect, double (*f)(TXsect* xsect, double u))
+//
+//  Input:   xsect = ptr. to a cross section data structure
+//           f = function that returns the exact normalized inverse at a
+//               normalized value u between 0 and 1
+//  Output:  returns a pointer to a new inverse table (or NULL if out of
+//           memory)
+//  Purpose: tabulates an inverse geometry function on a grid of evenly
+//           spaced normalized values.
+//
+//  NOTE: interpolation is checked at the quarter points of each grid
+//        interval against half of the GEOMETRY_TABLE_TOL tolerance;
+//        intervals that fail use the exact function instead. The grid is
+//        refined until no more than 1 in 32 intervals fail.
+//
+{
+    int    n, i, q, nExact;
+    double u, x;
+    TInvTable* table = NULL;
+
+    for (n = MIN_INV_INTERVALS; ; n *= 2)
+    {
+        // --- allocate a table with n grid intervals
+        invTable_delete(table);
+        table = (TInvTable *) malloc(sizeof(TInvTable));
+        if ( table == NULL ) return NULL;
+        table->n = n;
+        table->ref = 1.0;
+        table->x = (double *) malloc((n+1) * sizeof(double));
+        table->exact = (char *) calloc(n, sizeof(char));
+        if ( table->x == NULL || table->exact == NULL )
+        {
+            invTable_delete(table);
+            return NULL;
+        }
+
+        // --- evaluate f at each grid point
+        for (i = 0; i <= n; i++) table->x[i] = f(xsect, (double)i / n);
+
+        // --- flag intervals where interpolation is not accurate enough
+        nExact = 0;
+        for (i = 0; i < n; i++)
+        {
+            for (q = 1; q <= 3; q++)
+            {
+                u = (i + 0.25 * q) / n;
+                x = table->x[i] + 0.25 * q * (table->x[i+1] - table->x[i]);
+                if ( fabs(x - f(xsect, u)) > 0.5 * GeometryTol )
+                {
+                    table->exact[i] = TRUE;
+                    nExact++;
+                    break;
+                }
+            }
+        }
+        if ( 32 * nExact <= n || n >= MAX_INV_INTERVALS ) break;
+    }
+    return table;
+}
+
+//=============================================================================
+
+void invTable_delete(TInvTable* table)
+//
+//  Input:   table = ptr. to an inverse geometry table
+//  Output:  none
+//  Purpose: frees an inverse geometry table.
+//
+{
+    if ( table == NULL ) return;
+    FREE(table->x);
+    FREE(table->exact);
+    free(table);
+}
+
+//=============================================================================
+
+int invTable_lookup(TInvTable* table, double u, double* x)
+//
+//  Input:   table = ptr. to an inverse geometry table
+//           u = normalized value being inverted
+//  Output:  x = interpolated normalized inverse;
+//           returns TRUE if u lies in a grid interval that can be
+//           interpolated, FALSE if the exact inverse must be used
+//  Purpose: interpolates an inverse geometry table.
+//
+{
+    int    i;
+    double t;
+
+    if ( u < 0.0 ) return FALSE;
+    t = u * table->n;
+    if ( t >= table->n ) return FALSE;
+    i = (int)t;
+    if ( table->exact[i] ) return FALSE;
+    *x = table->x[i] + (t - i) * (table->x[i+1] - table->x[i]);
+    return TRUE;
+}
+
+//=============================================================================
+
+double invTable_getAofS(TXsect* xsect, double psi)
+//
+//  Input:   xsect = ptr. to a cross section data structure
+//           psi = section factor / full section factor
+//  Output:  returns area / full area
+//  Purpose: finds the exact normalized area at a normalized section factor.
+//
+{
+    return xsect_getAofS(xsect, psi * xsect->sFull) / xsect->aFull;
+}
+
+//=============================================================================
+
+double invTable_getYofA(TXsect* xsect, double alpha)
+//
+//  Input:   xsect = ptr. to a cross section data structure
+//           alpha = area / full area
+//  Output:  returns depth / full depth
+//  Purpose: finds the exact normalized depth at a normalized area.
+//
+{
+    return xsect_getYofA(xsect, alpha * xsect->aFull) / xsect->yFull;
+}
+
+//=============================================================================
+
+double invTable_getYofS(TXsect* xsect, double psi)
+//
+//  Input:   xsect = ptr. to a cross section data structure
+//           psi = section factor / full section factor
+//  Output:  returns depth / full depth
+//  Purpose: finds the exact normalized depth at a normalized section factor.
+//
+{
+    return xsect_getYofS(xsect, psi * xsect->sFull) / xsect->yFull;
+}
+
+//=============================================================================
+
+double invTable_getYcrit(TXsect* xsect, double u)
+//
+//  Input:   xsect = ptr. to a cross section data structure
+//           u = square root of flow / reference critical flow
+//  Output:  returns critical depth / full depth
+//  Purpose: finds the exact normalized critical depth at a normalized flow.
+//
+//  NOTE: the square root spreads the grid points evenly over depth near
+//        the bottom of the section, where critical flow grows as the
+//        square of depth for most shapes.
+//
+{
+    return xsect_getYcrit(xsect, u * u * invTable_getQref(xsect)) /
+           xsect->yFull;
+}
+
+//=============================================================================
+
+double invTable_getQref(TXsect* xsect)
+//
+//  Input:   xsect = ptr. to a cross section data structure
+//  Output:  returns a critical flow (cfs)
+//  Purpose: finds the critical flow at the top of a critical depth table
+//           (at full depth for open sections, slightly below it for closed
+//           ones, whose critical flow grows without bound as they fill)
+//
+{
+    double y, a, w;
+
+    y = xsect->yFull;
+    if ( !xsect_isOpen(xsect->type) ) y *= YCRIT_REF_DEPTH;
+    a = xsect_getAofY(xsect, y);
+    w = xsect_getWofY(xsect, y);
+    if ( w <= 0.0 ) return 0.0;
+    return a * sqrt(GRAVITY * a / w);
+}
+
+//=============================================================================
+
+void invTable_check(TXsect* xsect)
+//
+//  Input:   xsect = ptr. to a cross section data structure
+//  Output:  none
+//  Purpose: compares critical and normal depths found from a section's
+//           tables against exact values at points spread over each grid
+//           interval of the tables.
+//
+{
+    int    i, n;
+    double u, q, s, err;
+    TXsect exact = *xsect;
+
+    // --- a copy of the section without tables gives the exact values
+    exact.aOfS = NULL;
+    exact.yOfA = NULL;
+    exact.yOfS = NULL;
+    exact.yCrit = NULL;
+
+    if ( xsect->yCrit )
+    {
+        n = N_CHECK_POINTS * xsect->yCrit->n;
+        for (i = 0; i < n; i++)
+        {
+            u = (i + 0.5) / n;
+            q = u * u * xsect->yCrit->ref;
+            err = fabs(xsect_getYcrit(xsect, q) - xsect_getYcrit(&exact, q));
+            MaxYcritError = MAX(MaxYcritError, err / xsect->yFull);
+        }
+    }
+    if ( xsect->yOfS )
+    {
+        n = N_CHECK_POINTS * xsect->yOfS->n;
+        for (i = 0; i < n; i++)
+        {
+            s = (i + 0.5) / n * xsect->sFull;
+            err = fabs(xsect_getYofS(xsect, s) - xsect_getYofS(&exact, s));
+            MaxYnormError = MAX(MaxYnormError, err / xsect->yFull);
+        }
+    }
+}
+
+//=============================================================================
+
 double getQcritical(double yc, void* p)
 //
 //  Input:   yc = critical depth (ft)
@@ -2556,3 +3233,238 @@ double getThetaOfPsi(double psi)
 }
 
 //=============================================================================
+//  BATCHED geometry functions                                                 //(OPENSWMM 5.1.913)
+//=============================================================================
+
+//  A batch is split into runs of consecutive items with the same shape.
+//  Circular, rectangular and trapezoidal runs are evaluated by kernels
+//  whose loops contain no function calls or data dependent branches so
+//  the compiler can vectorize them. Items of other shapes are evaluated
+//  one at a time. Every kernel uses the same arithmetic as its scalar
+//  counterpart and so returns identical results.
+
+void getBatch(int func, TXsect* xsect[], double x[], double f[], int n)
+//
+//  Input:   func = geometry function code (AOFY, WOFY, ROFY or SOFA)
+//           xsect = array of ptrs. to cross section data structures
+//           x = array of function arguments
+//           n = number of items in the arrays
+//  Output:  f = array of function values
+//  Purpose: evaluates a geometry function over a batch of cross sections.
+//
+{
+    int i, j, k, type;
+
+    for (i = 0; i < n; i = j)
+    {
+        // --- find the run of items with the same shape as item i
+        type = xsect[i]->type;
+        for (j = i + 1; j < n; j++)
+        {
+            if ( xsect[j]->type != type ) break;
+        }
+
+        // --- evaluate the run
+        switch ( type )
+        {
+          case FORCE_MAIN:
+          case CIRCULAR:
+            circ_batch(func, &xsect[i], &x[i], &f[i], j - i);
+            break;
+
+          case RECT_CLOSED:
+            rect_closed_batch(func, &xsect[i], &x[i], &f[i], j - i);
+            break;
+
+          case RECT_OPEN:
+            rect_open_batch(func, &xsect[i], &x[i], &f[i], j - i);
+            break;
+
+          case TRAPEZOIDAL:
+            trapez_batch(func, &xsect[i], &x[i], &f[i], j - i);
+            break;
+
+          default:
+            for (k = i; k < j; k++) f[k] = getScalar(func, xsect[k], x[k]);
+        }
+    }
+}
+
+double getScalar(int func, TXsect* xsect, double x)
+{
+    switch ( func )
+    {
+      case AOFY: return xsect_getAofY(xsect, x);
+      case WOFY: return xsect_getWofY(xsect, x);
+      case ROFY: return xsect_getRofY(xsect, x);
+      default:   return xsect_getSofA(xsect, x);
+    }
+}
+
+double lookupKernel(double x, double *table, int nItems)
+//
+//  Same as lookup() but with its branches written as selections.
+//
+{
+    double delta, x0, x1, y, y2;
+    int    i, last;
+
+    delta = 1.0 / (nItems-1);
+    i = (int)(x / delta);
+    last = (i >= nItems - 1);
+    i = last ? nItems - 2 : i;
+    i = i < 0 ? 0 : i;
+    x0 = i * delta;
+    x1 = (i+1) * delta;
+    y = table[i] + (x - x0) * (table[i+1] - table[i]) / delta;
+    y2 = y + (x - x0) * (x - x1) / (delta*delta) *
+         (table[i]/2.0 - table[i+1] + table[MIN(i+2, nItems-1)]/2.0);
+    y = (i < 2 && y2 > 0.0) ? y2 : y;
+    y = y < 0.0 ? 0.0 : y;
+    return last ? table[nItems-1] : y;
+}
+
+void circ_batch(int func, TXsect* xsect[], double x[], double f[], int n)
+{
+    int    k;
+    double alpha;
+
+    switch ( func )
+    {
+      case AOFY:
+        for (k = 0; k < n; k++)
+        {
+            f[k] = xsect[k]->aFull *
+                   lookupKernel(x[k] / xsect[k]->yFull, A_Circ, N_A_Circ);
+            f[k] = x[k] <= 0.0 ? 0.0 : f[k];
+        }
+        break;
+
+      case WOFY:
+        for (k = 0; k < n; k++)
+            f[k] = xsect[k]->wMax *
+                   lookupKernel(x[k] / xsect[k]->yFull, W_Circ, N_W_Circ);
+        break;
+
+      case ROFY:
+        for (k = 0; k < n; k++)
+            f[k] = xsect[k]->rFull *
+                   lookupKernel(x[k] / xsect[k]->yFull, R_Circ, N_R_Circ);
+        break;
+
+      default:
+        for (k = 0; k < n; k++)
+            f[k] = xsect[k]->sFull *
+                   lookupKernel(x[k] / xsect[k]->aFull, S_Circ, N_S_Circ);
+
+        // --- use special function for small a/aFull
+        for (k = 0; k < n; k++)
+        {
+            alpha = x[k] / xsect[k]->aFull;
+            if ( alpha < 0.04 ) f[k] = xsect[k]->sFull * getScircular(alpha);
+        }
+    }
+}
+
+void rect_closed_batch(int func, TXsect* xsect[], double x[], double f[],
+                       int n)
+{
+    int    k;
+    double a, w, alf, p;
+
+    switch ( func )
+    {
+      case AOFY:
+        for (k = 0; k < n; k++)
+            f[k] = x[k] <= 0.0 ? 0.0 : x[k] * xsect[k]->wMax;
+        break;
+
+      case WOFY:
+        for (k = 0; k < n; k++) f[k] = xsect[k]->wMax;
+        break;
+
+      case ROFY:
+        for (k = 0; k < n; k++)
+        {
+            w = xsect[k]->wMax;
+            a = x[k] <= 0.0 ? 0.0 : x[k] * w;
+            p = w + 2.*a/w;
+            alf = a / xsect[k]->aFull;
+            p += alf > RECT_ALFMAX ?
+                 (alf - RECT_ALFMAX) / (1.0 - RECT_ALFMAX) * w : 0.0;
+            f[k] = a <= 0.0 ? 0.0 : a / p;
+        }
+        break;
+
+      default:
+        for (k = 0; k < n; k++) f[k] = rect_closed_getSofA(xsect[k], x[k]);
+    }
+}
+
+void rect_open_batch(int func, TXsect* xsect[], double x[], double f[],
+                     int n)
+{
+    int    k;
+    double a, w;
+
+    switch ( func )
+    {
+      case AOFY:
+        for (k = 0; k < n; k++)
+            f[k] = x[k] <= 0.0 ? 0.0 : x[k] * xsect[k]->wMax;
+        break;
+
+      case WOFY:
+        for (k = 0; k < n; k++) f[k] = xsect[k]->wMax;
+        break;
+
+      case ROFY:
+        for (k = 0; k < n; k++)
+        {
+            w = xsect[k]->wMax;
+            a = x[k] <= 0.0 ? 0.0 : x[k] * w;
+            f[k] = a / (w + (2. - xsect[k]->sBot) * a / w);
+            f[k] = a <= 0.0 ? 0.0 : f[k];
+        }
+        break;
+
+      default:
+        for (k = 0; k < n; k++) f[k] = rect_open_getSofA(xsect[k], x[k]);
+    }
+}
+
+void trapez_batch(int func, TXsect* xsect[], double x[], double f[], int n)
+{
+    int    k;
+    double y;
+
+    switch ( func )
+    {
+      case AOFY:
+        for (k = 0; k < n; k++)
+        {
+            y = x[k];
+            f[k] = ( xsect[k]->yBot + xsect[k]->sBot * y ) * y;
+            f[k] = y <= 0.0 ? 0.0 : f[k];
+        }
+        break;
+
+      case WOFY:
+        for (k = 0; k < n; k++)
+            f[k] = xsect[k]->yBot + 2.0 * x[k] * xsect[k]->sBot;
+        break;
+
+      case ROFY:
+        for (k = 0; k < n; k++)
+        {
+            y = x[k];
+            f[k] = ( xsect[k]->yBot + xsect[k]->sBot * y ) * y /
+                   (xsect[k]->yBot + y * xsect[k]->rBot);
+            f[k] = y == 0.0 ? 0.0 : f[k];
+        }
+        break;
+
+      default:
+        for (k = 0; k < n; k++) f[k] = xsect_getSofA(xsect[k], x[k]);
+    }
+}